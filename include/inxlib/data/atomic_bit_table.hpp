@@ -0,0 +1,377 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_ATOMIC_BIT_TABLE_HPP
+#define INXLIB_DATA_ATOMIC_BIT_TABLE_HPP
+
+#include <atomic>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <utility>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+/**
+ * @brief bit_table where cell writes are atomic, allowing concurrent writers.
+ *
+ * Every write uses std::atomic_ref on the containing word, with fetch operations where possible,
+ * so writers to different cells of the same word do not lose updates.
+ * Region operations use fetch ops or plain stores on words entirely within the region,
+ * and compare-exchange loops only on the boundary words shared with cells outside the region.
+ * region_op and region_copy stamp a source bit_table or bit_cell, e.g. for concurrent reservations.
+ *
+ * The bit_table is held rather than inherited, so only atomic mutators are exposed.
+ * table() gives a const view for the non-mutating bit_table functions, whose reads are plain
+ * and may observe a cell mid-update by a concurrent writer.
+ */
+template <size_t BitCount = 1, size_t BufferSize = 0, std::unsigned_integral PackType = size_t>
+class atomic_bit_table
+{
+public:
+	using table_type = bit_table<BitCount, BufferSize, PackType>;
+	using ops = details::bit_ops<BitCount, PackType>;
+	using index_t = typename table_type::index_t;
+	using op = typename table_type::op;
+	using pack_type = typename table_type::pack_type;
+	using atomic_ref = std::atomic_ref<pack_type>;
+	static_assert(atomic_ref::is_always_lock_free, "PackType must be lock free");
+
+	atomic_bit_table() noexcept = default;
+	atomic_bit_table(uint32 width, uint32 height, std::pmr::memory_resource* res = nullptr)
+	  : m_table(width, height, res)
+	{
+	}
+	explicit atomic_bit_table(const table_type& other)
+	  : m_table(other)
+	{
+	}
+	explicit atomic_bit_table(table_type&& other) noexcept
+	  : m_table(std::move(other))
+	{
+	}
+	atomic_bit_table(const atomic_bit_table&) = delete;
+	atomic_bit_table(atomic_bit_table&&) noexcept = default;
+	atomic_bit_table& operator=(const atomic_bit_table&) = delete;
+	atomic_bit_table& operator=(atomic_bit_table&&) = default;
+
+	/// const view of the table, reads do not synchronise with concurrent writers
+	const table_type& table() const noexcept { return m_table; }
+	uint32 getWidth() const noexcept { return m_table.getWidth(); }
+	uint32 getHeight() const noexcept { return m_table.getHeight(); }
+	index_t bit_index(int32 x, int32 y) const noexcept { return m_table.bit_index(x, y); }
+	const pack_type* data() const noexcept { return m_table.data(); }
+	/// moves the table out, leaving this empty, must not run concurrently with writers
+	table_type release() noexcept { return std::move(m_table); }
+
+	pack_type bit_get(int32 x, int32 y) const noexcept { return bit_get(m_table.bit_index(x, y)); }
+	void bit_set(int32 x, int32 y, pack_type value) noexcept { bit_set(m_table.bit_index(x, y), value); }
+	void bit_clear(int32 x, int32 y) noexcept { bit_clear(m_table.bit_index(x, y)); }
+	void bit_and(int32 x, int32 y, pack_type value) noexcept { bit_and(m_table.bit_index(x, y), value); }
+	void bit_or(int32 x, int32 y, pack_type value) noexcept { bit_or(m_table.bit_index(x, y), value); }
+	void bit_xor(int32 x, int32 y, pack_type value) noexcept { bit_xor(m_table.bit_index(x, y), value); }
+	void bit_nand(int32 x, int32 y, pack_type value) noexcept { bit_nand(m_table.bit_index(x, y), value); }
+	void bit_not(int32 x, int32 y) noexcept { bit_not(m_table.bit_index(x, y)); }
+	bool test_and_set(int32 x, int32 y) noexcept { return test_and_set(m_table.bit_index(x, y)); }
+	bool compare_exchange(int32 x, int32 y, pack_type& expected, pack_type desired) noexcept
+	{
+		return compare_exchange(m_table.bit_index(x, y), expected, desired);
+	}
+
+	pack_type bit_get(index_t id) const noexcept
+	{
+		return util::bit_right_shift<pack_type>(word_get(id), id.bit()) & ops::bit_mask;
+	}
+	void bit_set(index_t id, pack_type value) noexcept
+	{
+		assert(value <= ops::bit_mask);
+		if constexpr (BitCount == 1) {
+			if (value != 0)
+				ref(id).fetch_or(cell_mask(id));
+			else
+				ref(id).fetch_and(static_cast<pack_type>(~cell_mask(id)));
+		} else {
+			store_masked(ref(id), util::bit_left_shift<pack_type>(value, id.bit()), cell_mask(id));
+		}
+	}
+	void bit_clear(index_t id) noexcept { ref(id).fetch_and(static_cast<pack_type>(~cell_mask(id))); }
+	void bit_or(index_t id, pack_type value) noexcept
+	{
+		assert(value <= ops::bit_mask);
+		ref(id).fetch_or(util::bit_left_shift<pack_type>(value, id.bit()));
+	}
+	void bit_and(index_t id, pack_type value) noexcept
+	{
+		assert(value <= ops::bit_mask);
+		ref(id).fetch_and(static_cast<pack_type>(~util::bit_left_shift<pack_type>((~value) & ops::bit_mask, id.bit())));
+	}
+	void bit_xor(index_t id, pack_type value) noexcept
+	{
+		assert(value <= ops::bit_mask);
+		ref(id).fetch_xor(util::bit_left_shift<pack_type>(value, id.bit()));
+	}
+	void bit_nand(index_t id, pack_type value) noexcept
+	{
+		assert(value <= ops::bit_mask);
+		fetch_nand(ref(id), util::bit_left_shift<pack_type>(value, id.bit()), cell_mask(id));
+	}
+	void bit_not(index_t id) noexcept { ref(id).fetch_xor(cell_mask(id)); }
+
+	/// sets the cell to all 1 bits, returning true if any bit of the cell was previously set
+	bool test_and_set(index_t id) noexcept
+	{
+		const pack_type mask = cell_mask(id);
+		return (ref(id).fetch_or(mask) & mask) != 0;
+	}
+	/// atomically replace cell with desired if equal to expected, otherwise loads cell into expected
+	bool compare_exchange(index_t id, pack_type& expected, pack_type desired) noexcept
+	{
+		assert(expected <= ops::bit_mask && desired <= ops::bit_mask);
+		const pack_type mask = cell_mask(id);
+		atomic_ref r = ref(id);
+		pack_type old = r.load(std::memory_order_relaxed);
+		while (true) {
+			pack_type cur = util::bit_right_shift<pack_type>(old, id.bit()) & ops::bit_mask;
+			if (cur != expected) {
+				expected = cur;
+				return false;
+			}
+			if (r.compare_exchange_weak(
+			      old, static_cast<pack_type>((old & ~mask) | util::bit_left_shift<pack_type>(desired, id.bit()))))
+				return true;
+		}
+	}
+
+	pack_type word_get(index_t id) const noexcept
+	{
+		return std::atomic_ref<pack_type>(const_cast<pack_type&>(m_table.data()[id.word()])).load();
+	}
+	void word_set(index_t id, pack_type value) noexcept { ref(id).store(value); }
+
+	/**
+	 * @brief Set every cell in region to value.
+	 *        Words covered by the region are stored, boundary words use compare-exchange.
+	 */
+	void region_fill(pack_type value, int32 o_x, int32 o_y, int32 width, int32 height) noexcept
+	{
+		const pack_type fill = ops::fill_word(value);
+		region_apply(o_x, o_y, width, height, [fill](atomic_ref r, pack_type mask) noexcept {
+			if (mask == cells_word)
+				r.store(fill);
+			else
+				store_masked(r, fill, mask);
+		});
+	}
+	void region_op_fill(op OP, pack_type value)
+	{
+		region_op_fill(OP, value, 0, 0, m_table.getWidth(), m_table.getHeight());
+	}
+	void region_op_fill(op OP, pack_type value, int32 o_x, int32 o_y, int32 width, int32 height)
+	{
+		const pack_type fill = ops::fill_word(value);
+		switch (OP) {
+		case op::OR:
+			region_apply(o_x, o_y, width, height, [fill](atomic_ref r, pack_type mask) noexcept {
+				r.fetch_or(fill & mask);
+			});
+			break;
+		case op::AND:
+			region_apply(o_x, o_y, width, height, [fill](atomic_ref r, pack_type mask) noexcept {
+				r.fetch_and(static_cast<pack_type>(fill | ~mask));
+			});
+			break;
+		case op::XOR:
+			region_apply(o_x, o_y, width, height, [fill](atomic_ref r, pack_type mask) noexcept {
+				r.fetch_xor(fill & mask);
+			});
+			break;
+		case op::NAND:
+			region_apply(o_x, o_y, width, height, [fill](atomic_ref r, pack_type mask) noexcept {
+				fetch_nand(r, fill, mask);
+			});
+			break;
+		default:
+			assert(false);
+		}
+	}
+
+	/**
+	 * @brief Combine the cells of src with OP into the region of its size at (x, y), as src.region_op(OP, *this, x, y).
+	 *        Every word uses a single fetch op masked to the region, so concurrent stamps do not lose updates.
+	 */
+	template <size_t SrcBufferSize>
+	void region_op(op OP, const bit_table<BitCount, SrcBufferSize, PackType>& src, int32 x, int32 y) noexcept
+	{
+		region_op_src(OP, x, y, src.getWidth(), src.getHeight(), table_rows(src));
+	}
+	void region_op(op OP, const bit_cell<BitCount, PackType>& src, int32 x, int32 y) noexcept
+	{
+		region_op_src(OP, x, y, src.getWidth(), src.getHeight(), cell_rows(src));
+	}
+	/**
+	 * @brief Copy the cells of src into the region of its size at (x, y).
+	 *        Words covered by the region are stored, boundary words use compare-exchange.
+	 */
+	template <size_t SrcBufferSize>
+	void region_copy(const bit_table<BitCount, SrcBufferSize, PackType>& src, int32 x, int32 y) noexcept
+	{
+		region_copy_src(x, y, src.getWidth(), src.getHeight(), table_rows(src));
+	}
+	void region_copy(const bit_cell<BitCount, PackType>& src, int32 x, int32 y) noexcept
+	{
+		region_copy_src(x, y, src.getWidth(), src.getHeight(), cell_rows(src));
+	}
+
+protected:
+	atomic_ref ref(index_t id) noexcept { return atomic_ref(m_table.data()[id.word()]); }
+	static pack_type cell_mask(index_t id) noexcept { return util::bit_left_shift<pack_type>(ops::bit_mask, id.bit()); }
+	static void store_masked(atomic_ref r, pack_type value, pack_type mask) noexcept
+	{
+		pack_type old = r.load(std::memory_order_relaxed);
+		while (!r.compare_exchange_weak(old, static_cast<pack_type>((old & ~mask) | (value & mask))))
+			;
+	}
+
+	/// cell = ~(cell & value) on the bits of mask: bits where value is 0 are set, bits where it is 1 flip,
+	/// as two fetch ops on disjoint bits
+	static void fetch_nand(atomic_ref r, pack_type value, pack_type mask) noexcept
+	{
+		r.fetch_or(static_cast<pack_type>(~value & mask));
+		r.fetch_xor(static_cast<pack_type>(value & mask));
+	}
+
+	/// bits used by cells in a word, excludes padding bits when BitCount is not a power of 2
+	static constexpr pack_type cells_word = ops::fill_word(ops::bit_mask);
+
+	/// calls fn(y, row, word, mask) for each word of each row y of region, mask selects the region cell bits
+	template <typename Fn>
+	void region_words(int32 o_x, int32 o_y, int32 width, int32 height, Fn&& fn) noexcept
+	{
+		assert(-static_cast<int32>(BufferSize) <= o_x && width > 0 &&
+		       o_x + width <= static_cast<int32>(m_table.getWidth() + BufferSize));
+		assert(-static_cast<int32>(BufferSize) <= o_y && height > 0 &&
+		       o_y + height <= static_cast<int32>(m_table.getHeight() + BufferSize));
+		const size_t first = static_cast<size_t>(o_x + static_cast<int32>(BufferSize)) << ops::bit_adj;
+		const size_t last = first + (static_cast<size_t>(width) << ops::bit_adj); // exclusive
+		const size_t w1 = first >> ops::pack_bits_size, w2 = (last - 1) >> ops::pack_bits_size;
+		const pack_type m1 = ~util::make_mask<pack_type>(first & ops::pack_bits_mask) & cells_word;
+		const pack_type m2 = util::make_mask<pack_type>(((last - 1) & ops::pack_bits_mask) + 1) & cells_word;
+		for (int32 y = o_y, ye = o_y + height; y < ye; ++y) {
+			pack_type* row = m_table.row_data(y);
+			if (w1 == w2) {
+				fn(y, row, w1, static_cast<pack_type>(m1 & m2));
+			} else {
+				fn(y, row, w1, m1);
+				for (size_t w = w1 + 1; w < w2; ++w)
+					fn(y, row, w, cells_word);
+				fn(y, row, w2, m2);
+			}
+		}
+	}
+	/// calls fn(word, mask) for each word of each row of region
+	template <typename Fn>
+	void region_apply(int32 o_x, int32 o_y, int32 width, int32 height, Fn&& fn) noexcept
+	{
+		region_words(o_x, o_y, width, height, [&fn](int32, pack_type* row, size_t w, pack_type mask) noexcept {
+			fn(atomic_ref(row[w]), mask);
+		});
+	}
+	/**
+	 * @brief Calls fn(word, src, mask) for each word of each row of region, where src holds the source cells
+	 *        aligned to the word. src_row(i) gives {row, first} for row i of the source, first the bit of its
+	 *        first cell in row.
+	 */
+	template <typename SrcRow, typename Fn>
+	void region_apply_src(int32 o_x, int32 o_y, int32 width, int32 height, SrcRow&& src_row, Fn&& fn) noexcept
+	{
+		const int64 first = static_cast<int64>(o_x + static_cast<int32>(BufferSize)) << ops::bit_adj;
+		const int64 bits = static_cast<int64>(width) << ops::bit_adj;
+		region_words(o_x, o_y, width, height, [&](int32 y, pack_type* row, size_t w, pack_type mask) noexcept {
+			const auto [src, src_first] = src_row(y - o_y);
+			const int64 pos = src_first + (static_cast<int64>(w) << ops::pack_bits_size) - first;
+			fn(atomic_ref(row[w]), details::bit_row_read<pack_type>(src, pos, src_first + bits), mask);
+		});
+	}
+	template <typename SrcRow>
+	void region_op_src(op OP, int32 o_x, int32 o_y, int32 width, int32 height, SrcRow&& src_row) noexcept
+	{
+		switch (OP) {
+		case op::OR:
+			region_apply_src(o_x, o_y, width, height, src_row, [](atomic_ref r, pack_type v, pack_type mask) noexcept {
+				r.fetch_or(v & mask);
+			});
+			break;
+		case op::AND:
+			region_apply_src(o_x, o_y, width, height, src_row, [](atomic_ref r, pack_type v, pack_type mask) noexcept {
+				r.fetch_and(static_cast<pack_type>(v | ~mask));
+			});
+			break;
+		case op::XOR:
+			region_apply_src(o_x, o_y, width, height, src_row, [](atomic_ref r, pack_type v, pack_type mask) noexcept {
+				r.fetch_xor(v & mask);
+			});
+			break;
+		case op::NAND:
+			region_apply_src(o_x, o_y, width, height, src_row, [](atomic_ref r, pack_type v, pack_type mask) noexcept {
+				fetch_nand(r, v, mask);
+			});
+			break;
+		default:
+			assert(false);
+		}
+	}
+	template <typename SrcRow>
+	void region_copy_src(int32 o_x, int32 o_y, int32 width, int32 height, SrcRow&& src_row) noexcept
+	{
+		region_apply_src(o_x, o_y, width, height, src_row, [](atomic_ref r, pack_type v, pack_type mask) noexcept {
+			if (mask == cells_word)
+				r.store(v);
+			else
+				store_masked(r, v, mask);
+		});
+	}
+	/// source rows of a bit_table
+	template <size_t SrcBufferSize>
+	static auto table_rows(const bit_table<BitCount, SrcBufferSize, PackType>& src) noexcept
+	{
+		return [&src](int32 i) noexcept {
+			return std::pair<const pack_type*, int64>(src.row_data(i),
+			                                          static_cast<int64>(SrcBufferSize) << ops::bit_adj);
+		};
+	}
+	/// source rows of a bit_cell, rows are packed one after another
+	static auto cell_rows(const bit_cell<BitCount, PackType>& src) noexcept
+	{
+		return [data = src.data(), row_bits = static_cast<int64>(src.getWidth()) << ops::bit_adj](int32 i) noexcept {
+			return std::pair<const pack_type*, int64>(data, i * row_bits);
+		};
+	}
+
+	table_type m_table;
+};
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_ATOMIC_BIT_TABLE_HPP
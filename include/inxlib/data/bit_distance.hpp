@@ -0,0 +1,319 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_DISTANCE_HPP
+#define INXLIB_DATA_BIT_DISTANCE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <inxlib/util/parallel.hpp>
+#include <vector>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+enum class distance_metric
+{
+	manhattan, ///< exact L1 distance
+	chamfer,   ///< two-pass 3x3 chamfer, orthogonal 1 and diagonal sqrt(2)
+	euclidean  ///< exact euclidean distance, Felzenszwalb-Huttenlocher
+};
+
+/**
+ * @brief Distance from every cell to the nearest set (obstacle) cell of a bit_table<1>.
+ *
+ * Manhattan and euclidean are computed separably, first a per-column vertical distance
+ * then a per-row transform, with both passes split across threads.
+ * Obstacle rows are scanned a word at a time, only visiting set bits.
+ * Only cells of the table are considered, the buffer is ignored.
+ * Cells with no obstacle reachable are infinity.
+ */
+template <typename Dist = float>
+class distance_field
+{
+public:
+	static_assert(std::is_floating_point_v<Dist>, "Dist must be floating point");
+	using value_type = Dist;
+	static constexpr Dist infinity = std::numeric_limits<Dist>::infinity();
+
+	distance_field() noexcept
+	  : m_width(0)
+	  , m_height(0)
+	  , m_metric(distance_metric::euclidean)
+	{
+	}
+
+	/**
+	 * @brief Compute the distance field of obstacles.
+	 * @param threads number of threads to split row and column passes across, chamfer is always serial
+	 */
+	template <size_t BufferSize, std::unsigned_integral PackType>
+	void build(const bit_table<1, BufferSize, PackType>& obstacles,
+	           distance_metric metric = distance_metric::euclidean,
+	           uint32 threads = 1)
+	{
+		m_width = obstacles.getWidth();
+		m_height = obstacles.getHeight();
+		m_metric = metric;
+		m_dist.resize(static_cast<size_t>(m_width) * m_height);
+		if (m_dist.empty())
+			return;
+		if (metric == distance_metric::chamfer) {
+			m_column.clear();
+			build_chamfer(obstacles);
+			return;
+		}
+		m_column.resize(static_cast<size_t>(m_width) * m_height);
+		util::parallel_ranges(
+		  0, m_width, threads, 64, [this, &obstacles](int64 c1, int64 c2) { column_pass(obstacles, c1, c2); });
+		util::parallel_ranges(0, m_height, threads, 1, [this](int64 y1, int64 y2) { row_pass(y1, y2, nullptr); });
+	}
+
+	/**
+	 * @brief Update the field after obstacles changed only within region (x,y,width,height).
+	 *        Recomputes the columns of region, then only the rows whose column distances changed.
+	 *        Chamfer, or obstacles of different dimensions, recompute the whole field.
+	 */
+	template <size_t BufferSize, std::unsigned_integral PackType>
+	void update(const bit_table<1, BufferSize, PackType>& obstacles,
+	            int32 x,
+	            int32 y,
+	            int32 width,
+	            int32 height,
+	            uint32 threads = 1)
+	{
+		if (m_metric == distance_metric::chamfer || obstacles.getWidth() != m_width ||
+		    obstacles.getHeight() != m_height) {
+			build(obstacles, m_metric, threads);
+			return;
+		}
+		int32 c1 = std::max(x, 0), c2 = std::min(x + width, static_cast<int32>(m_width));
+		if (c1 >= c2 || y >= static_cast<int32>(m_height) || y + height <= 0 || m_dist.empty())
+			return;
+		const size_t cols = static_cast<size_t>(c2 - c1);
+		std::vector<uint32> old(cols * m_height);
+		for (uint32 i = 0; i < m_height; ++i)
+			std::copy_n(&m_column[i * static_cast<size_t>(m_width) + c1], cols, &old[i * cols]);
+		util::parallel_ranges(
+		  c1, c2, threads, 64, [this, &obstacles](int64 l1, int64 l2) { column_pass(obstacles, l1, l2); });
+		std::vector<uint8> changed(m_height);
+		for (uint32 i = 0; i < m_height; ++i)
+			changed[i] = !std::equal(old.begin() + i * cols,
+			                         old.begin() + (i + 1) * cols,
+			                         m_column.begin() + i * static_cast<size_t>(m_width) + c1);
+		util::parallel_ranges(
+		  0, m_height, threads, 1, [this, &changed](int64 y1, int64 y2) { row_pass(y1, y2, changed.data()); });
+	}
+
+	uint32 getWidth() const noexcept { return m_width; }
+	uint32 getHeight() const noexcept { return m_height; }
+	distance_metric getMetric() const noexcept { return m_metric; }
+
+	Dist get(int32 x, int32 y) const noexcept
+	{
+		assert(static_cast<uint32>(x) < m_width && static_cast<uint32>(y) < m_height);
+		return m_dist[static_cast<size_t>(y) * m_width + x];
+	}
+	const Dist* row_data(int32 y) const noexcept
+	{
+		assert(static_cast<uint32>(y) < m_height);
+		return m_dist.data() + static_cast<size_t>(y) * m_width;
+	}
+	const Dist* data() const noexcept { return m_dist.data(); }
+
+protected:
+	static constexpr uint32 column_inf = std::numeric_limits<uint32>::max();
+
+	/// vertical distance to nearest obstacle in each column of [c1,c2)
+	template <size_t BufferSize, std::unsigned_integral PackType>
+	void column_pass(const bit_table<1, BufferSize, PackType>& obstacles, int64 c1, int64 c2)
+	{
+		constexpr int64 pack_bits = sizeof(PackType) * CHAR_BIT;
+		const int64 limit = BufferSize + static_cast<int64>(m_width);
+		const size_t w = m_width;
+		for (uint32 y = 0; y < m_height; ++y) {
+			uint32* g = &m_column[y * w];
+			if (y == 0) {
+				std::fill(g + c1, g + c2, column_inf);
+			} else {
+				const uint32* p = g - w;
+				for (int64 c = c1; c < c2; ++c)
+					g[c] = p[c] == column_inf ? column_inf : p[c] + 1;
+			}
+			const PackType* row = obstacles.row_data(static_cast<int32>(y));
+			for (int64 c = c1; c < c2; c += pack_bits) {
+				PackType word = details::bit_row_read(row, c + static_cast<int64>(BufferSize), limit);
+				if (c2 - c < pack_bits)
+					word &= util::make_mask<PackType>(static_cast<size_t>(c2 - c));
+				for (; word != 0; word &= word - 1)
+					g[c + util::ctz(word)] = 0;
+			}
+		}
+		for (uint32 y = m_height - 1; y-- > 0;) {
+			uint32* g = &m_column[y * w];
+			const uint32* n = g + w;
+			for (int64 c = c1; c < c2; ++c)
+				if (n[c] != column_inf)
+					g[c] = std::min(g[c], n[c] + 1);
+		}
+	}
+
+	/// per row transform of the column distances, if update is given rows where update[y] == 0 are skipped
+	void row_pass(int64 y1, int64 y2, const uint8* update)
+	{
+		const size_t w = m_width;
+		std::vector<int64> v;
+		std::vector<double> z;
+		if (m_metric == distance_metric::euclidean) {
+			v.resize(w);
+			z.resize(w + 1);
+		}
+		for (int64 y = y1; y < y2; ++y) {
+			if (update != nullptr && update[y] == 0)
+				continue;
+			const uint32* g = &m_column[y * w];
+			Dist* d = &m_dist[y * w];
+			if (m_metric == distance_metric::manhattan) {
+				Dist prev = infinity;
+				for (size_t x = 0; x < w; ++x)
+					d[x] = prev = std::min(g[x] == column_inf ? infinity : static_cast<Dist>(g[x]), prev + 1);
+				prev = infinity;
+				for (size_t x = w; x-- > 0;)
+					d[x] = prev = std::min(d[x], prev + 1);
+			} else {
+				edt_row(g, d, v.data(), z.data());
+			}
+		}
+	}
+
+	/// Felzenszwalb-Huttenlocher lower envelope of parabolas, skipping columns with no obstacle
+	void edt_row(const uint32* g, Dist* d, int64* v, double* z) const
+	{
+		const int64 w = m_width;
+		auto f = [g](int64 q) -> double { return static_cast<double>(g[q]) * static_cast<double>(g[q]); };
+		int64 k = -1;
+		for (int64 q = 0; q < w; ++q) {
+			if (g[q] == column_inf)
+				continue;
+			if (k < 0) {
+				k = 0;
+				v[0] = q;
+				z[0] = -std::numeric_limits<double>::infinity();
+				z[1] = std::numeric_limits<double>::infinity();
+				continue;
+			}
+			double s;
+			while (true) {
+				const int64 p = v[k];
+				s = ((f(q) + static_cast<double>(q * q)) - (f(p) + static_cast<double>(p * p))) /
+				    static_cast<double>(2 * (q - p));
+				if (s > z[k])
+					break;
+				--k;
+			}
+			++k;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = std::numeric_limits<double>::infinity();
+		}
+		if (k < 0) {
+			std::fill_n(d, w, infinity);
+			return;
+		}
+		k = 0;
+		for (int64 q = 0; q < w; ++q) {
+			while (z[k + 1] < static_cast<double>(q))
+				++k;
+			const int64 dx = q - v[k];
+			d[q] = static_cast<Dist>(std::sqrt(static_cast<double>(dx * dx) + f(v[k])));
+		}
+	}
+
+	template <size_t BufferSize, std::unsigned_integral PackType>
+	void build_chamfer(const bit_table<1, BufferSize, PackType>& obstacles)
+	{
+		constexpr int64 pack_bits = sizeof(PackType) * CHAR_BIT;
+		constexpr Dist a = 1, b = static_cast<Dist>(1.4142135623730951);
+		const int64 w = m_width, h = m_height;
+		const int64 limit = BufferSize + w;
+		std::fill(m_dist.begin(), m_dist.end(), infinity);
+		for (int64 y = 0; y < h; ++y) {
+			const PackType* row = obstacles.row_data(static_cast<int32>(y));
+			Dist* d = &m_dist[y * w];
+			for (int64 c = 0; c < w; c += pack_bits) {
+				for (PackType word = details::bit_row_read(row, c + static_cast<int64>(BufferSize), limit); word != 0;
+				     word &= word - 1)
+					d[c + util::ctz(word)] = 0;
+			}
+		}
+		// forward pass
+		for (int64 y = 0; y < h; ++y) {
+			Dist* d = &m_dist[y * w];
+			const Dist* u = y > 0 ? d - w : nullptr;
+			for (int64 x = 0; x < w; ++x) {
+				Dist m = d[x];
+				if (x > 0)
+					m = std::min(m, d[x - 1] + a);
+				if (u != nullptr) {
+					m = std::min(m, u[x] + a);
+					if (x > 0)
+						m = std::min(m, u[x - 1] + b);
+					if (x + 1 < w)
+						m = std::min(m, u[x + 1] + b);
+				}
+				d[x] = m;
+			}
+		}
+		// backward pass
+		for (int64 y = h; y-- > 0;) {
+			Dist* d = &m_dist[y * w];
+			const Dist* n = y + 1 < h ? d + w : nullptr;
+			for (int64 x = w; x-- > 0;) {
+				Dist m = d[x];
+				if (x + 1 < w)
+					m = std::min(m, d[x + 1] + a);
+				if (n != nullptr) {
+					m = std::min(m, n[x] + a);
+					if (x + 1 < w)
+						m = std::min(m, n[x + 1] + b);
+					if (x > 0)
+						m = std::min(m, n[x - 1] + b);
+				}
+				d[x] = m;
+			}
+		}
+	}
+
+	uint32 m_width, m_height;
+	distance_metric m_metric;
+	std::vector<uint32> m_column; ///< vertical distance to nearest obstacle, unused by chamfer
+	std::vector<Dist> m_dist;
+};
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_DISTANCE_HPP
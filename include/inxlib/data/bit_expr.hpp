@@ -0,0 +1,324 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_EXPR_HPP
+#define INXLIB_DATA_BIT_EXPR_HPP
+
+#include <functional>
+#include <inxlib/inx.hpp>
+#include <vector>
+#include <inxlib/util/bits.hpp>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+/**
+ * Lazy boolean expressions over bit_tables of the same shape.
+ *
+ * Operators &, |, ^ and ~ on bit_tables, and bit_table::shifted, build an expression tree
+ * of row readers instead of tables. Assigning the expression to a bit_table evaluates it
+ * in a single pass over the words of each row with no temporary tables, e.g.
+ * dst = (a & b) | ~c ^ d.shifted(1, 0);
+ * Operands must share BitCount and PackType, and may have any BufferSize.
+ * Cells shifted in from outside an operand read its buffer, or 0 past the buffer.
+ * dst may appear within its own expression. If it appears shifted, each row is evaluated into
+ * scratch rows and written back once no later row reads its original cells.
+ */
+
+namespace details {
+template <typename T>
+concept bit_expr_table_like = requires(const T& t) {
+	T::buffer_size;
+	typename T::pack_type;
+	t.row_data(0);
+	t.getPadWidth();
+};
+
+/// reads a word of cells at an arbitrary bit offset of a row, 0 if row is null
+template <std::unsigned_integral PackType>
+struct bit_expr_row_read
+{
+	static constexpr size_t pack_bits = sizeof(PackType) * CHAR_BIT;
+	const PackType* row;
+	int64 offset;
+	int64 limit;
+	PackType operator()(size_t i) const noexcept
+	{
+		return row != nullptr ? bit_row_read(row, static_cast<int64>(i * pack_bits) + offset, limit) : PackType{0};
+	}
+};
+/// reads a word of a row with the same layout
+template <std::unsigned_integral PackType>
+struct bit_expr_row_word
+{
+	const PackType* row;
+	PackType operator()(size_t i) const noexcept { return row[i]; }
+};
+
+/// cells of a table shifted by (dx,dy)
+template <typename Table>
+class bit_expr_shift : public bit_expr_tag
+{
+public:
+	using pack_type = typename Table::pack_type;
+	static constexpr size_t bit_count = Table::bit_count;
+	static constexpr size_t buffer_size = Table::buffer_size;
+
+	bit_expr_shift(const Table& table, int32 dx, int32 dy) noexcept
+	  : m_table(&table)
+	  , m_dx(dx)
+	  , m_dy(dy)
+	{
+	}
+
+	uint32 getWidth() const noexcept { return m_table->getWidth(); }
+	uint32 getHeight() const noexcept { return m_table->getHeight(); }
+	/// rows past y that read row y of table, or -1 if table is not read shifted
+	int32 alias_rows(const void* table) const noexcept
+	{
+		return table == m_table && (m_dx != 0 || m_dy != 0) ? std::max(m_dy, 0) : -1;
+	}
+
+	template <size_t DestBuffer>
+	bit_expr_row_read<pack_type> row(int32 y) const noexcept
+	{
+		const int32 sy = y - m_dy;
+		const int32 bs = static_cast<int32>(buffer_size);
+		const pack_type* r =
+		  -bs <= sy && sy < static_cast<int32>(m_table->getHeight()) + bs ? m_table->row_data(sy) : nullptr;
+		return {r,
+		        (static_cast<int64>(buffer_size) - static_cast<int64>(DestBuffer) - m_dx) << Table::bit_adj,
+		        static_cast<int64>(m_table->getPadWidth()) << Table::bit_adj};
+	}
+
+private:
+	const Table* m_table;
+	int32 m_dx, m_dy;
+};
+
+/// cells of a table
+template <typename Table>
+class bit_expr_table : public bit_expr_tag
+{
+public:
+	using pack_type = typename Table::pack_type;
+	static constexpr size_t bit_count = Table::bit_count;
+	static constexpr size_t buffer_size = Table::buffer_size;
+
+	explicit bit_expr_table(const Table& table) noexcept
+	  : m_table(&table)
+	{
+	}
+
+	uint32 getWidth() const noexcept { return m_table->getWidth(); }
+	uint32 getHeight() const noexcept { return m_table->getHeight(); }
+	int32 alias_rows(const void*) const noexcept { return -1; }
+
+	template <size_t DestBuffer>
+	auto row(int32 y) const noexcept
+	{
+		if constexpr (DestBuffer == buffer_size) {
+			return bit_expr_row_word<pack_type>{m_table->row_data(y)};
+		} else {
+			return bit_expr_row_read<pack_type>{
+			  m_table->row_data(y),
+			  (static_cast<int64>(buffer_size) - static_cast<int64>(DestBuffer)) << Table::bit_adj,
+			  static_cast<int64>(m_table->getPadWidth()) << Table::bit_adj};
+		}
+	}
+
+private:
+	const Table* m_table;
+};
+
+template <typename Expr>
+class bit_expr_not : public bit_expr_tag
+{
+public:
+	using pack_type = typename Expr::pack_type;
+	static constexpr size_t bit_count = Expr::bit_count;
+
+	explicit bit_expr_not(const Expr& expr) noexcept
+	  : m_expr(expr)
+	{
+	}
+
+	uint32 getWidth() const noexcept { return m_expr.getWidth(); }
+	uint32 getHeight() const noexcept { return m_expr.getHeight(); }
+	int32 alias_rows(const void* table) const noexcept { return m_expr.alias_rows(table); }
+
+	template <size_t DestBuffer>
+	auto row(int32 y) const noexcept
+	{
+		return [r = m_expr.template row<DestBuffer>(y)](size_t i) noexcept { return static_cast<pack_type>(~r(i)); };
+	}
+
+private:
+	Expr m_expr;
+};
+
+template <typename Op, typename Left, typename Right>
+class bit_expr_binary : public bit_expr_tag
+{
+public:
+	static_assert(std::same_as<typename Left::pack_type, typename Right::pack_type>, "PackType must match");
+	static_assert(Left::bit_count == Right::bit_count, "BitCount must match");
+	using pack_type = typename Left::pack_type;
+	static constexpr size_t bit_count = Left::bit_count;
+
+	bit_expr_binary(const Left& left, const Right& right) noexcept
+	  : m_left(left)
+	  , m_right(right)
+	{
+		assert(left.getWidth() == right.getWidth() && left.getHeight() == right.getHeight());
+	}
+
+	uint32 getWidth() const noexcept { return m_left.getWidth(); }
+	uint32 getHeight() const noexcept { return m_left.getHeight(); }
+	int32 alias_rows(const void* table) const noexcept
+	{
+		return std::max(m_left.alias_rows(table), m_right.alias_rows(table));
+	}
+
+	template <size_t DestBuffer>
+	auto row(int32 y) const noexcept
+	{
+		return [l = m_left.template row<DestBuffer>(y), r = m_right.template row<DestBuffer>(y)](size_t i) noexcept {
+			return static_cast<pack_type>(Op{}(l(i), r(i)));
+		};
+	}
+
+private:
+	Left m_left;
+	Right m_right;
+};
+
+template <typename T>
+auto
+bit_expr_wrap(const T& operand) noexcept
+{
+	if constexpr (std::derived_from<T, bit_expr_tag>)
+		return operand;
+	else
+		return bit_expr_table<T>(operand);
+}
+
+template <typename T>
+concept bit_expr_operand = std::derived_from<T, bit_expr_tag> || bit_expr_table_like<T>;
+
+/**
+ * @brief Evaluate expr into the table cells of dst, a word at a time, the buffer is unchanged
+ */
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType, typename Expr>
+void
+bit_expr_assign(bit_table<BitCount, BufferSize, PackType>& dst, const Expr& expr)
+{
+	using table = bit_table<BitCount, BufferSize, PackType>;
+	static_assert(std::same_as<typename Expr::pack_type, PackType>, "PackType must match");
+	static_assert(Expr::bit_count == BitCount, "BitCount must match");
+	assert(dst.getWidth() == expr.getWidth() && dst.getHeight() == expr.getHeight());
+	constexpr size_t pack_bits = table::pack_bits;
+	// padding bits between cells of non power of 2 BitCount stay 0
+	constexpr PackType cells = table::fill_word(table::bit_mask);
+	const int64 begin = static_cast<int64>(BufferSize) << table::bit_adj;
+	const int64 end = static_cast<int64>(BufferSize + dst.getWidth()) << table::bit_adj;
+	const size_t first = static_cast<size_t>(begin >> table::pack_bits_size);
+	const size_t last = static_cast<size_t>((end - 1) >> table::pack_bits_size);
+	PackType head = static_cast<PackType>(~util::make_mask<PackType>(static_cast<size_t>(begin) & (pack_bits - 1)));
+	PackType tail = util::make_mask<PackType>(static_cast<size_t>((end - 1) & (pack_bits - 1)) + 1);
+	if (first == last)
+		head &= tail;
+	head &= cells;
+	tail &= cells;
+	const int32 height = static_cast<int32>(dst.getHeight());
+	auto write_row = [&](int32 y, const auto& r) {
+		PackType* out = dst.row_data(y);
+		out[first] = (out[first] & ~head) | (r(first) & head);
+		if (first == last)
+			return;
+		for (size_t i = first + 1; i < last; ++i)
+			out[i] = r(i) & cells;
+		out[last] = (out[last] & ~tail) | (r(last) & tail);
+	};
+	const int32 delay = expr.alias_rows(&dst);
+	if (delay < 0) {
+		for (int32 y = 0; y < height; ++y)
+			write_row(y, expr.template row<BufferSize>(y));
+		return;
+	}
+	// dst is read shifted, hold each row in scratch until the rows reading it below have been evaluated
+	const size_t slots = static_cast<size_t>(delay) + 1;
+	std::vector<PackType> scratch(slots * (last + 1));
+	auto slot = [&](int32 y) {
+		return bit_expr_row_word<PackType>{&scratch[(static_cast<size_t>(y) % slots) * (last + 1)]};
+	};
+	for (int32 y = 0; y < height; ++y) {
+		auto r = expr.template row<BufferSize>(y);
+		PackType* s = &scratch[(static_cast<size_t>(y) % slots) * (last + 1)];
+		for (size_t i = first; i <= last; ++i)
+			s[i] = r(i);
+		if (y >= delay)
+			write_row(y - delay, slot(y - delay));
+	}
+	for (int32 y = std::max(height - delay, 0); y < height; ++y)
+		write_row(y, slot(y));
+}
+} // namespace details
+
+template <details::bit_expr_operand L, details::bit_expr_operand R>
+auto
+operator&(const L& left, const R& right) noexcept
+{
+	auto l = details::bit_expr_wrap(left);
+	auto r = details::bit_expr_wrap(right);
+	return details::bit_expr_binary<std::bit_and<>, decltype(l), decltype(r)>(l, r);
+}
+template <details::bit_expr_operand L, details::bit_expr_operand R>
+auto
+operator|(const L& left, const R& right) noexcept
+{
+	auto l = details::bit_expr_wrap(left);
+	auto r = details::bit_expr_wrap(right);
+	return details::bit_expr_binary<std::bit_or<>, decltype(l), decltype(r)>(l, r);
+}
+template <details::bit_expr_operand L, details::bit_expr_operand R>
+auto
+operator^(const L& left, const R& right) noexcept
+{
+	auto l = details::bit_expr_wrap(left);
+	auto r = details::bit_expr_wrap(right);
+	return details::bit_expr_binary<std::bit_xor<>, decltype(l), decltype(r)>(l, r);
+}
+template <details::bit_expr_operand E>
+auto
+operator~(const E& expr) noexcept
+{
+	auto e = details::bit_expr_wrap(expr);
+	return details::bit_expr_not<decltype(e)>(e);
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_EXPR_HPP
@@ -0,0 +1,184 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_FILL_HPP
+#define INXLIB_DATA_BIT_FILL_HPP
+
+#include <algorithm>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <vector>
+
+#include "bit_kernel.hpp"
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+namespace details {
+/// @brief Kogge-Stone occluded fill of gen through pro towards the msb
+template <std::unsigned_integral PackType>
+constexpr PackType
+bit_fill_up(PackType gen, PackType pro) noexcept
+{
+	for (size_t i = 1; i < sizeof(PackType) * CHAR_BIT; i <<= 1) {
+		gen |= pro & static_cast<PackType>(gen << i);
+		pro &= static_cast<PackType>(pro << i);
+	}
+	return gen;
+}
+/// @brief Kogge-Stone occluded fill of gen through pro towards the lsb
+template <std::unsigned_integral PackType>
+constexpr PackType
+bit_fill_down(PackType gen, PackType pro) noexcept
+{
+	for (size_t i = 1; i < sizeof(PackType) * CHAR_BIT; i <<= 1) {
+		gen |= pro & static_cast<PackType>(gen >> i);
+		pro &= static_cast<PackType>(pro >> i);
+	}
+	return gen;
+}
+} // namespace details
+
+/**
+ * @brief Grow the set cells of out through the clear cells of src, until no row changes.
+ *
+ * Each row is filled a word at a time with Kogge-Stone span fills, carrying across words,
+ * after OR-ing in the (for moore, diagonally widened) rows above and below.
+ * Only rows with a changed neighbour are revisited, sweeping down then up.
+ * Set cells of out that are set in src are cleared. Cells outside the table are blocked.
+ * @param kernel von_neumann for 4-connectivity, moore for 8-connectivity
+ */
+template <size_t BufferSize, std::unsigned_integral PackType>
+void
+flood_fill_seeds(const bit_table<1, BufferSize, PackType>& src,
+                 bit_table<1, BufferSize, PackType>& out,
+                 neighbor_kernel kernel = neighbor_kernel::von_neumann)
+{
+	assert(src.getWidth() == out.getWidth() && src.getHeight() == out.getHeight());
+	assert(src.getRowWords() == out.getRowWords());
+	constexpr size_t pack_bits = sizeof(PackType) * CHAR_BIT;
+	constexpr PackType top_bit = util::bit_left_shift<pack_bits - 1>(PackType{1});
+	const int32 height = static_cast<int32>(src.getHeight());
+	const size_t row_words = src.getRowWords();
+	// passable cells of a row are clear cells of src within the table columns
+	std::vector<PackType> valid(row_words, 0);
+	details::bit_row_fill<PackType>(valid.data(), BufferSize, src.getWidth(), static_cast<PackType>(~PackType{0}));
+	std::vector<PackType> pass(row_words), seed(row_words);
+	std::vector<uint8> pending(height, 0);
+
+	// OR row into seed, widened by one cell either side for moore
+	auto add_row = [&](const PackType* row) {
+		if (kernel == neighbor_kernel::moore) {
+			PackType lo = 0;
+			for (size_t i = 0; i < row_words; ++i) {
+				PackType hi = i + 1 < row_words ? row[i + 1] : 0;
+				seed[i] |= row[i] | static_cast<PackType>(row[i] << 1) | static_cast<PackType>(row[i] >> 1) |
+				           static_cast<PackType>(lo >> (pack_bits - 1)) | static_cast<PackType>(hi << (pack_bits - 1));
+				lo = row[i];
+			}
+		} else {
+			for (size_t i = 0; i < row_words; ++i)
+				seed[i] |= row[i];
+		}
+	};
+	auto process = [&](int32 y) {
+		pending[y] = 0;
+		PackType* orow = out.row_data(y);
+		const PackType* srow = src.row_data(y);
+		for (size_t i = 0; i < row_words; ++i) {
+			pass[i] = static_cast<PackType>(~srow[i]) & valid[i];
+			seed[i] = orow[i];
+		}
+		if (y > 0)
+			add_row(out.row_data(y - 1));
+		if (y + 1 < height)
+			add_row(out.row_data(y + 1));
+		bool carry = false;
+		for (size_t i = 0; i < row_words; ++i) {
+			PackType g = (seed[i] | (carry ? PackType{1} : PackType{0})) & pass[i];
+			seed[i] = g = details::bit_fill_up(g, pass[i]);
+			carry = (g & top_bit) != 0;
+		}
+		carry = false;
+		for (size_t i = row_words; i-- > 0;) {
+			PackType g = seed[i] | (carry ? top_bit & pass[i] : PackType{0});
+			seed[i] = g = details::bit_fill_down(g, pass[i]);
+			carry = (g & 1) != 0;
+		}
+		if (!std::equal(seed.begin(), seed.end(), orow)) {
+			std::copy(seed.begin(), seed.end(), orow);
+			if (y > 0)
+				pending[y - 1] = 1;
+			if (y + 1 < height)
+				pending[y + 1] = 1;
+		}
+	};
+
+	// rows holding seeds and their neighbours start pending
+	for (int32 y = 0; y < height; ++y) {
+		const PackType* orow = out.row_data(y);
+		if (std::any_of(orow, orow + row_words, [](PackType w) { return w != 0; })) {
+			for (int32 i = std::max(y - 1, 0); i <= std::min(y + 1, height - 1); ++i)
+				pending[i] = 1;
+		}
+	}
+	for (bool any = true; any;) {
+		any = false;
+		for (int32 y = 0; y < height; ++y)
+			if (pending[y] != 0) {
+				process(y);
+				any = true;
+			}
+		for (int32 y = height; y-- > 0;)
+			if (pending[y] != 0) {
+				process(y);
+				any = true;
+			}
+	}
+}
+
+/**
+ * @brief Mark in out every cell reachable from (x,y) through the clear cells of src.
+ *        out must match the dimensions of src, and is overwritten.
+ * @param kernel von_neumann for 4-connectivity, moore for 8-connectivity
+ */
+template <size_t BufferSize, std::unsigned_integral PackType>
+void
+flood_fill(const bit_table<1, BufferSize, PackType>& src,
+           int32 x,
+           int32 y,
+           bit_table<1, BufferSize, PackType>& out,
+           neighbor_kernel kernel = neighbor_kernel::von_neumann)
+{
+	assert(static_cast<uint32>(x) < src.getWidth() && static_cast<uint32>(y) < src.getHeight());
+	std::fill_n(out.data(), out.calc_cells_words(), PackType{0});
+	if (src.bit_get(x, y) != 0)
+		return;
+	out.bit_set(x, y, 1);
+	flood_fill_seeds(src, out, kernel);
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_FILL_HPP
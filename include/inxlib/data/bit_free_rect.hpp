@@ -0,0 +1,249 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_FREE_RECT_HPP
+#define INXLIB_DATA_BIT_FREE_RECT_HPP
+
+#include <algorithm>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <limits>
+#include <vector>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+enum class rect_fit
+{
+	first, ///< top-most then left-most placement
+	best   ///< placement in the smallest maximal empty rectangle that fits
+};
+
+namespace details {
+/**
+ * @brief Per-column heights of clear cells ending at the current row of a region.
+ *
+ * Rows are read a word at a time, each word increments its columns then resets the
+ * columns of its set cells found with ctz, so mostly clear rows cost one pass of adds.
+ * An extra zero height past the region ends the stack-histogram scans.
+ */
+template <size_t BufferSize, std::unsigned_integral PackType>
+class free_rect_heights
+{
+public:
+	static constexpr uint32 pack_bits = sizeof(PackType) * CHAR_BIT;
+
+	free_rect_heights(const bit_table<1, BufferSize, PackType>& table, const bit_rect& region)
+	  : m_table(table)
+	  , m_region(region)
+	  , m_heights(static_cast<size_t>(region.width) + 1, 0)
+	{
+		assert(region.x >= 0 && region.y >= 0 && region.width >= 0 && region.height >= 0);
+		assert(static_cast<uint32>(region.x + region.width) <= table.getWidth());
+		assert(static_cast<uint32>(region.y + region.height) <= table.getHeight());
+	}
+
+	/// advance to table row y, returns false if every cell of the row is set
+	bool next_row(int32 y) noexcept
+	{
+		const PackType* row = m_table.row_data(y);
+		const int64 pos = static_cast<int64>(BufferSize) + m_region.x;
+		const int64 limit = pos + m_region.width;
+		bool any_clear = false;
+		for (uint32 i = 0; i < static_cast<uint32>(m_region.width); i += pack_bits) {
+			const uint32 n = std::min(pack_bits, static_cast<uint32>(m_region.width) - i);
+			PackType w = bit_row_read(row, pos + i, limit);
+			uint32* h = m_heights.data() + i;
+			if (w == 0) {
+				for (uint32 k = 0; k < n; ++k)
+					h[k] += 1;
+				any_clear = true;
+			} else if (w == util::make_mask<PackType>(n)) {
+				std::fill_n(h, n, 0u);
+			} else {
+				for (uint32 k = 0; k < n; ++k)
+					h[k] += 1;
+				for (; w != 0; w &= w - 1)
+					h[util::ctz(w)] = 0;
+				any_clear = true;
+			}
+		}
+		return any_clear;
+	}
+
+	/// true if the row below y is past the region or has a set cell in [x, x+width) of the region
+	bool below_blocked(int32 y, int32 x, int32 width) const noexcept
+	{
+		if (y + 1 >= m_region.y + m_region.height)
+			return true;
+		const PackType* row = m_table.row_data(y + 1);
+		const int64 pos = static_cast<int64>(BufferSize) + m_region.x + x;
+		const int64 limit = pos + width;
+		for (int64 i = pos; i < limit; i += pack_bits) {
+			if (bit_row_read(row, i, limit) != 0)
+				return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Stack-histogram scan of the current row heights.
+	 *
+	 * Calls fn(x, width, height) for every empty rectangle ending at the current row that
+	 * cannot grow left, right or up, x relative to the region.
+	 */
+	template <typename Fn>
+	void scan(Fn&& fn)
+	{
+		m_stack.clear();
+		const uint32 width = static_cast<uint32>(m_region.width);
+		for (uint32 x = 0; x <= width; ++x) {
+			const uint32 cur = m_heights[x];
+			while (!m_stack.empty() && m_heights[m_stack.back()] >= cur) {
+				const uint32 h = m_heights[m_stack.back()];
+				m_stack.pop_back();
+				// equal heights continue right, reported by the last of them
+				if (h != 0 && h != cur) {
+					const uint32 left = m_stack.empty() ? 0 : m_stack.back() + 1;
+					fn(static_cast<int32>(left), static_cast<int32>(x - left), static_cast<int32>(h));
+				}
+			}
+			m_stack.push_back(x);
+		}
+	}
+
+	const std::vector<uint32>& heights() const noexcept { return m_heights; }
+
+private:
+	const bit_table<1, BufferSize, PackType>& m_table;
+	bit_rect m_region;
+	std::vector<uint32> m_heights;
+	std::vector<uint32> m_stack;
+};
+} // namespace details
+
+/**
+ * @brief Largest area rectangle of clear cells within region.
+ *
+ * Runs the stack-histogram algorithm over per-column clear heights, updated a word at a time.
+ * Ties keep the rectangle with the top-most bottom row, then left-most.
+ * @return the rectangle in table coordinates, empty if every cell is set
+ */
+template <size_t BufferSize, std::unsigned_integral PackType>
+bit_rect
+largest_empty_rect(const bit_table<1, BufferSize, PackType>& table, const bit_rect& region)
+{
+	bit_rect best{0, 0, 0, 0};
+	int64 best_area = 0;
+	details::free_rect_heights<BufferSize, PackType> heights(table, region);
+	for (int32 y = region.y; y < region.y + region.height; ++y) {
+		if (!heights.next_row(y))
+			continue;
+		heights.scan([&](int32 x, int32 w, int32 h) {
+			if (int64 area = static_cast<int64>(w) * h; area > best_area) {
+				best_area = area;
+				best = bit_rect{region.x + x, y - h + 1, w, h};
+			}
+		});
+	}
+	return best;
+}
+template <size_t BufferSize, std::unsigned_integral PackType>
+bit_rect
+largest_empty_rect(const bit_table<1, BufferSize, PackType>& table)
+{
+	return largest_empty_rect(
+	  table, bit_rect{0, 0, static_cast<int32>(table.getWidth()), static_cast<int32>(table.getHeight())});
+}
+
+/**
+ * @brief Find a width by height rectangle of clear cells within region.
+ *
+ * rect_fit::first returns the top-most, then left-most placement, stopping at the first row
+ * it completes on. rect_fit::best scans every maximal empty rectangle (those that cannot
+ * grow in any direction) and places at the top-left of the smallest area one that fits.
+ * @return the placement in table coordinates, empty if none fits
+ */
+template <size_t BufferSize, std::unsigned_integral PackType>
+bit_rect
+find_free_rect(const bit_table<1, BufferSize, PackType>& table,
+               const bit_rect& region,
+               int32 width,
+               int32 height,
+               rect_fit policy = rect_fit::first)
+{
+	assert(width > 0 && height > 0);
+	bit_rect best{0, 0, 0, 0};
+	if (width > region.width || height > region.height)
+		return best;
+	details::free_rect_heights<BufferSize, PackType> heights(table, region);
+	if (policy == rect_fit::first) {
+		for (int32 y = region.y; y < region.y + region.height; ++y) {
+			if (!heights.next_row(y) || y - region.y + 1 < height)
+				continue;
+			const auto& h = heights.heights();
+			int32 run = 0;
+			for (int32 x = 0; x < region.width; ++x) {
+				run = h[x] >= static_cast<uint32>(height) ? run + 1 : 0;
+				if (run == width)
+					return bit_rect{region.x + x - width + 1, y - height + 1, width, height};
+			}
+		}
+	} else {
+		int64 best_area = std::numeric_limits<int64>::max();
+		for (int32 y = region.y; y < region.y + region.height; ++y) {
+			if (!heights.next_row(y))
+				continue;
+			heights.scan([&](int32 x, int32 w, int32 h) {
+				const int64 area = static_cast<int64>(w) * h;
+				if (w < width || h < height || area >= best_area)
+					return;
+				// skip rectangles that continue into the next row
+				if (!heights.below_blocked(y, x, w))
+					return;
+				best_area = area;
+				best = bit_rect{region.x + x, y - h + 1, width, height};
+			});
+		}
+	}
+	return best;
+}
+template <size_t BufferSize, std::unsigned_integral PackType>
+bit_rect
+find_free_rect(const bit_table<1, BufferSize, PackType>& table,
+               int32 width,
+               int32 height,
+               rect_fit policy = rect_fit::first)
+{
+	return find_free_rect(table,
+	                      bit_rect{0, 0, static_cast<int32>(table.getWidth()), static_cast<int32>(table.getHeight())},
+	                      width,
+	                      height,
+	                      policy);
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_FREE_RECT_HPP
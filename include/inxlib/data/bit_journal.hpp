@@ -0,0 +1,338 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_JOURNAL_HPP
+#define INXLIB_DATA_BIT_JOURNAL_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <inxlib/inx.hpp>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+/// patch record, followed by count words XOR-ed into padded row at word
+struct bit_journal_record
+{
+	uint32 row; ///< padded row, from 0 for the first buffer row
+	uint32 word;
+	uint32 count;
+};
+static_assert(sizeof(bit_journal_record) == 12);
+
+enum class journal_status
+{
+	ok,        ///< stream read to its end
+	truncated, ///< stream ended within a record, e.g. a torn write, earlier records are applied
+	invalid    ///< header or record does not match the table, later records are not applied
+};
+
+struct journal_replay
+{
+	journal_status status;
+	uint64 records;    ///< records applied
+	uint64 bytes;      ///< bytes of the header and applied records, the length of the journal to keep
+	uint64 generation; ///< snapshot generation a journal continuing from the table is based on
+};
+
+/**
+ * @brief Append-only journal of XOR patches to the words of a bit_table.
+ *
+ * Edits made through the journal are applied to the table and recorded as runs of
+ * changed words (row, word, count, XOR words), buffered and written to out in blocks.
+ * Replaying the journal over the base snapshot the journal started from rebuilds the table,
+ * the header records the generation of that snapshot and replay rejects any other.
+ * Edits made directly on the table can be recorded with record_diff against a copy.
+ *
+ * After a restart, either replay the journal and continue it with the journal_replay constructor,
+ * which appends without a second header, or compact it and start a new journal on the new generation.
+ */
+template <size_t BitCount = 1, size_t BufferSize = 0, std::unsigned_integral PackType = size_t>
+class bit_journal
+{
+public:
+	using table_type = bit_table<BitCount, BufferSize, PackType>;
+	using pack_type = PackType;
+	static constexpr size_t default_buffer_bytes = 64 * 1024;
+
+	/// starts a journal over table, which holds the snapshot of generation, writing the header to out
+	bit_journal(table_type& table, std::ostream& out, uint64 generation = 0, size_t buffer_bytes = default_buffer_bytes)
+	  : m_table(&table)
+	  , m_out(&out)
+	  , m_capacity(std::max(buffer_bytes, sizeof(bit_journal_record) + sizeof(pack_type)))
+	  , m_generation(generation)
+	{
+		m_buffer.reserve(m_capacity);
+		put_header();
+	}
+	/**
+	 * @brief Continues the journal replay read into table, appending to out without a second header.
+	 *        out must be positioned at replayed.bytes, so a torn final record must be cut off first.
+	 *        Writes the header if replay found none.
+	 */
+	bit_journal(table_type& table,
+	            std::ostream& out,
+	            const journal_replay& replayed,
+	            size_t buffer_bytes = default_buffer_bytes)
+	  : m_table(&table)
+	  , m_out(&out)
+	  , m_capacity(std::max(buffer_bytes, sizeof(bit_journal_record) + sizeof(pack_type)))
+	  , m_generation(replayed.generation)
+	{
+		assert(replayed.status != journal_status::invalid);
+		m_buffer.reserve(m_capacity);
+		if (replayed.bytes == 0) {
+			put_header();
+		} else {
+			m_records = replayed.records;
+			m_bytes = replayed.bytes;
+		}
+	}
+	bit_journal(const bit_journal&) = delete;
+	~bit_journal() { flush(); }
+
+	/// XOR count words of patch into padded row y (from -buffer_size) at word
+	void xor_words(int32 y, uint32 word, const pack_type* patch, uint32 count)
+	{
+		pack_type* row = row_words(y, word, count);
+		for (uint32 i = 0; i < count; ++i)
+			row[i] ^= patch[i];
+		record_runs(y, word, patch, count);
+	}
+	/// overwrite count words of padded row y (from -buffer_size) at word, recording only changed words
+	void write_words(int32 y, uint32 word, const pack_type* words, uint32 count)
+	{
+		pack_type* row = row_words(y, word, count);
+		m_patch.resize(count);
+		for (uint32 i = 0; i < count; ++i) {
+			m_patch[i] = static_cast<pack_type>(row[i] ^ words[i]);
+			row[i] = words[i];
+		}
+		record_runs(y, word, m_patch.data(), count);
+	}
+	/// record the words of rows [y1, y2) that differ from base, a copy of the table before the edits
+	void record_diff(const table_type& base, int32 y1, int32 y2)
+	{
+		assert(base.getWidth() == m_table->getWidth() && base.getHeight() == m_table->getHeight());
+		assert(base.getRowWords() == m_table->getRowWords());
+		const uint32 words = m_table->getRowWords();
+		m_patch.resize(words);
+		for (int32 y = y1; y < y2; ++y) {
+			const pack_type* a = base.row_data(y);
+			const pack_type* b = m_table->row_data(y);
+			for (uint32 i = 0; i < words; ++i)
+				m_patch[i] = static_cast<pack_type>(a[i] ^ b[i]);
+			record_runs(y, 0, m_patch.data(), words);
+		}
+	}
+	void record_diff(const table_type& base)
+	{
+		record_diff(base, -static_cast<int32>(BufferSize), static_cast<int32>(m_table->getHeight() + BufferSize));
+	}
+
+	/// write buffered records to out
+	void flush()
+	{
+		if (!m_buffer.empty()) {
+			m_out->write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+			m_buffer.clear();
+		}
+		m_out->flush();
+	}
+
+	uint64 records() const noexcept { return m_records; }
+	/// bytes written and buffered, including the header
+	uint64 bytes() const noexcept { return m_bytes; }
+	/// generation of the base snapshot
+	uint64 generation() const noexcept { return m_generation; }
+
+private:
+	void put_header()
+	{
+		const auto head = bit_table_header::make(bit_table_header::journal_magic, *m_table, m_generation);
+		put(&head, sizeof(head));
+	}
+	pack_type* row_words(int32 y, uint32 word, uint32 count) noexcept
+	{
+		assert(word + count <= m_table->getRowWords());
+		return m_table->row_data(y) + word;
+	}
+	/// record each run of non-zero patch words
+	void record_runs(int32 y, uint32 word, const pack_type* patch, uint32 count)
+	{
+		for (uint32 i = 0; i < count;) {
+			if (patch[i] == 0) {
+				++i;
+				continue;
+			}
+			uint32 j = i + 1;
+			while (j < count && patch[j] != 0)
+				++j;
+			const bit_journal_record rec{static_cast<uint32>(y + static_cast<int32>(BufferSize)), word + i, j - i};
+			put(&rec, sizeof(rec));
+			put(patch + i, (j - i) * sizeof(pack_type));
+			++m_records;
+			i = j;
+		}
+	}
+	void put(const void* data, size_t size)
+	{
+		m_bytes += size;
+		if (m_buffer.size() + size > m_capacity) {
+			flush();
+			if (size >= m_capacity) {
+				m_out->write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+				return;
+			}
+		}
+		const char* p = static_cast<const char*>(data);
+		m_buffer.insert(m_buffer.end(), p, p + size);
+	}
+
+	table_type* m_table;
+	std::ostream* m_out;
+	size_t m_capacity;
+	uint64 m_generation;
+	std::vector<char> m_buffer;
+	std::vector<pack_type> m_patch;
+	uint64 m_records = 0;
+	uint64 m_bytes = 0;
+};
+
+/**
+ * @brief Apply the patches of a journal to table, which must hold the base snapshot the journal
+ *        was started from, of the given generation. Stops at the first torn or invalid record.
+ *        A journal of another generation or layout is invalid and nothing is applied.
+ */
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+journal_replay
+replay(std::istream& in, bit_table<BitCount, BufferSize, PackType>& table, uint64 generation)
+{
+	journal_replay res{journal_status::ok, 0, 0, generation};
+	bit_table_header head;
+	if (!in.read(reinterpret_cast<char*>(&head), sizeof(head))) {
+		res.status = journal_status::truncated;
+		return res;
+	}
+	if (head != bit_table_header::make(bit_table_header::journal_magic, table, generation)) {
+		res.status = journal_status::invalid;
+		return res;
+	}
+	res.bytes = sizeof(head);
+	std::vector<PackType> patch;
+	bit_journal_record rec;
+	while (in.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+		if (rec.row >= table.getPadHeight() || rec.count > table.getRowWords() ||
+		    rec.word > table.getRowWords() - rec.count) {
+			res.status = journal_status::invalid;
+			return res;
+		}
+		patch.resize(rec.count);
+		if (!in.read(reinterpret_cast<char*>(patch.data()),
+		             static_cast<std::streamsize>(rec.count * sizeof(PackType)))) {
+			res.status = journal_status::truncated;
+			return res;
+		}
+		PackType* row = table.row_data(static_cast<int32>(rec.row) - static_cast<int32>(BufferSize)) + rec.word;
+		for (uint32 i = 0; i < rec.count; ++i)
+			row[i] ^= patch[i];
+		++res.records;
+		res.bytes += sizeof(rec) + rec.count * sizeof(PackType);
+	}
+	if (in.gcount() != 0)
+		res.status = journal_status::truncated;
+	return res;
+}
+
+/// write a bit_table_header and the word buffer of table as the snapshot of generation
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+void
+write_snapshot(std::ostream& out, const bit_table<BitCount, BufferSize, PackType>& table, uint64 generation = 0)
+{
+	const auto head = bit_table_header::make(bit_table_header::snapshot_magic, table, generation);
+	out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+	out.write(reinterpret_cast<const char*>(table.data()),
+	          static_cast<std::streamsize>(table.calc_cells_words() * sizeof(PackType)));
+}
+/// read a snapshot written by write_snapshot, table is set up to its dimensions and generation set to its own
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+journal_status
+read_snapshot(std::istream& in, bit_table<BitCount, BufferSize, PackType>& table, uint64& generation)
+{
+	bit_table_header head;
+	if (!in.read(reinterpret_cast<char*>(&head), sizeof(head)))
+		return journal_status::truncated;
+	if (head.magic != bit_table_header::snapshot_magic || head.version != bit_table_header::current_version ||
+	    !head.same_layout<BitCount, BufferSize, PackType>() || head.width == 0 || head.height == 0)
+		return journal_status::invalid;
+	table.setup(head.width, head.height);
+	if (table.getRowWords() != head.row_words)
+		return journal_status::invalid;
+	if (!in.read(reinterpret_cast<char*>(table.data()),
+	             static_cast<std::streamsize>(table.calc_cells_words() * sizeof(PackType))))
+		return journal_status::truncated;
+	generation = head.generation;
+	return journal_status::ok;
+}
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+journal_status
+read_snapshot(std::istream& in, bit_table<BitCount, BufferSize, PackType>& table)
+{
+	uint64 generation;
+	return read_snapshot(in, table, generation);
+}
+
+/**
+ * @brief Fold a journal into its base snapshot, writing the new snapshot to out as the next generation.
+ *        A journal with a torn final record is folded up to that record. Nothing is written if
+ *        the snapshot or journal is invalid.
+ * @return the replay result with generation set to that of the written snapshot,
+ *         or the snapshot read status if it was not ok
+ */
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+journal_replay
+compact(std::istream& snapshot,
+        std::istream& journal,
+        std::ostream& out,
+        bit_table<BitCount, BufferSize, PackType>& table)
+{
+	uint64 generation = 0;
+	if (journal_status status = read_snapshot(snapshot, table, generation); status != journal_status::ok)
+		return {status, 0, 0, generation};
+	journal_replay res = replay(journal, table, generation);
+	if (res.status != journal_status::invalid) {
+		res.generation = generation + 1;
+		write_snapshot(out, table, res.generation);
+	}
+	return res;
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_JOURNAL_HPP
@@ -0,0 +1,130 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_KERNEL_HPP
+#define INXLIB_DATA_BIT_KERNEL_HPP
+
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+enum class neighbor_kernel
+{
+	moore,      ///< 8 surrounding cells
+	von_neumann ///< 4 orthogonal cells
+};
+
+namespace details {
+template <std::unsigned_integral PackType>
+constexpr void
+bit_half_add(PackType a, PackType b, PackType& sum, PackType& carry) noexcept
+{
+	sum = a ^ b;
+	carry = a & b;
+}
+template <std::unsigned_integral PackType>
+constexpr void
+bit_full_add(PackType a, PackType b, PackType c, PackType& sum, PackType& carry) noexcept
+{
+	PackType t = a ^ b;
+	sum = t ^ c;
+	carry = (a & b) | (t & c);
+}
+} // namespace details
+
+/**
+ * @brief Count the set neighbours of every cell in src, storing the 4-bit count in out.
+ *
+ * Counts are computed bit-sliced, a whole word of cells at a time, by summing shifted
+ * neighbour rows through a carry-save adder tree.
+ * Cells in the src buffer are counted as neighbours, cells past the buffer are 0.
+ * out must match the dimensions of src.
+ */
+template <size_t SrcBuffer, size_t DestBuffer, std::unsigned_integral PackType>
+void
+neighbor_count(const bit_table<1, SrcBuffer, PackType>& src,
+               bit_table<4, DestBuffer, PackType>& out,
+               neighbor_kernel kernel = neighbor_kernel::moore)
+{
+	assert(src.getWidth() == out.getWidth() && src.getHeight() == out.getHeight());
+	constexpr uint32 pack_bits = sizeof(PackType) * CHAR_BIT;
+	constexpr uint32 lane_cells = pack_bits / 4;
+	const int32 width = static_cast<int32>(src.getWidth());
+	const int32 height = static_cast<int32>(src.getHeight());
+	const int64 limit = src.getPadWidth();
+	auto row_at = [&src, height](int32 y) -> const PackType* {
+		return -static_cast<int32>(SrcBuffer) <= y && y < height + static_cast<int32>(SrcBuffer) ? src.row_data(y)
+		                                                                                        : nullptr;
+	};
+	auto fetch = [limit](const PackType* row, int64 pos) -> PackType {
+		return row != nullptr ? details::bit_row_read(row, pos, limit) : 0;
+	};
+
+	for (int32 y = 0; y < height; ++y) {
+		const PackType* rn = row_at(y - 1);
+		const PackType* rc = src.row_data(y);
+		const PackType* rs = row_at(y + 1);
+		PackType* orow = out.row_data(y);
+		for (int32 x = 0; x < width; x += pack_bits) {
+			const int64 pos = x + static_cast<int64>(SrcBuffer);
+			PackType c0, c1, c2, c3;
+			if (kernel == neighbor_kernel::moore) {
+				PackType s1, k1, s2, k2, s3, k3, k4, t, k5, k6;
+				details::bit_full_add(fetch(rn, pos - 1), fetch(rn, pos), fetch(rn, pos + 1), s1, k1);
+				details::bit_full_add(fetch(rs, pos - 1), fetch(rs, pos), fetch(rs, pos + 1), s2, k2);
+				details::bit_half_add(fetch(rc, pos - 1), fetch(rc, pos + 1), s3, k3);
+				details::bit_full_add(s1, s2, s3, c0, k4);
+				details::bit_full_add(k1, k2, k3, t, k5);
+				details::bit_half_add(t, k4, c1, k6);
+				details::bit_half_add(k5, k6, c2, c3);
+			} else {
+				PackType s1, k1, s2, k2, k3;
+				details::bit_half_add(fetch(rn, pos), fetch(rs, pos), s1, k1);
+				details::bit_half_add(fetch(rc, pos - 1), fetch(rc, pos + 1), s2, k2);
+				details::bit_half_add(s1, s2, c0, k3);
+				details::bit_full_add(k1, k2, k3, c1, c2);
+				c3 = 0;
+			}
+			// interleave the 4 bit planes into 4-bit lanes
+			const uint32 count = std::min<uint32>(pack_bits, static_cast<uint32>(width - x));
+			for (uint32 i = 0; i < count; i += lane_cells) {
+				PackType v = util::bit_spread<4>(util::bit_right_shift<PackType>(c0, i)) |
+				             util::bit_left_shift<1>(util::bit_spread<4>(util::bit_right_shift<PackType>(c1, i))) |
+				             util::bit_left_shift<2>(util::bit_spread<4>(util::bit_right_shift<PackType>(c2, i))) |
+				             util::bit_left_shift<3>(util::bit_spread<4>(util::bit_right_shift<PackType>(c3, i)));
+				details::bit_row_write(orow,
+				                       (x + i + static_cast<int64>(DestBuffer)) << 2,
+				                       v,
+				                       util::make_mask<PackType>(std::min(lane_cells, count - i) << 2));
+			}
+		}
+	}
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_KERNEL_HPP
@@ -0,0 +1,287 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_RANDOM_HPP
+#define INXLIB_DATA_BIT_RANDOM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <inxlib/util/parallel.hpp>
+#include <inxlib/util/xoshiro256.hpp>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+/**
+ * @brief Uniform sampling of the set (or clear) cells of a bit_table.
+ *
+ * Keeps a prefix index of popcounts per block of row words. A draw binary searches the
+ * index for its block, popcounts at most block_words words, then selects the bit in the
+ * word with util::bit_select, so the cost does not depend on the population density.
+ * The index must be rebuilt after the table is modified.
+ */
+template <size_t BufferSize, std::unsigned_integral PackType>
+class bit_sampler
+{
+public:
+	using table_type = bit_table<1, BufferSize, PackType>;
+	using pack_type = PackType;
+	static constexpr uint32 pack_bits = sizeof(pack_type) * CHAR_BIT;
+	static constexpr uint32 block_words = 8;
+
+	/// @param set sample the set cells if true, otherwise the clear cells
+	bit_sampler(const table_type& table, bool set)
+	  : m_table(&table)
+	  , m_set(set)
+	{
+		rebuild();
+	}
+
+	/// rebuild the index from the current table
+	void rebuild()
+	{
+		const uint32 width = m_table->getWidth(), height = m_table->getHeight();
+		m_first_word = static_cast<uint32>(BufferSize / pack_bits);
+		m_words = width == 0 ? 0 : static_cast<uint32>((BufferSize + width - 1) / pack_bits) - m_first_word + 1;
+		m_row_blocks = (m_words + block_words - 1) / block_words;
+		m_prefix.resize(static_cast<size_t>(height) * m_row_blocks + 1);
+		uint64 total = 0;
+		size_t b = 0;
+		for (uint32 y = 0; y < height; ++y) {
+			for (uint32 i = 0; i < m_words; i += block_words) {
+				m_prefix[b++] = total;
+				for (uint32 j = i; j < std::min(i + block_words, m_words); ++j)
+					total += static_cast<uint64>(util::popcount(word(static_cast<int32>(y), j)));
+			}
+		}
+		m_prefix[b] = total;
+	}
+
+	/// number of cells that can be drawn
+	uint64 population() const noexcept { return m_prefix.back(); }
+
+	/// draw one cell, population() must not be 0
+	template <std::uniform_random_bit_generator Rng>
+	bit_point sample(Rng& rng) const
+	{
+		assert(population() > 0);
+		uint64 r = std::uniform_int_distribution<uint64>(0, population() - 1)(rng);
+		// last block whose prefix is <= r, blocks with no cells share the prefix of the next
+		const size_t b =
+		  static_cast<size_t>(std::upper_bound(m_prefix.begin(), m_prefix.end(), r) - m_prefix.begin()) - 1;
+		r -= m_prefix[b];
+		const int32 y = static_cast<int32>(b / m_row_blocks);
+		for (uint32 i = static_cast<uint32>(b % m_row_blocks) * block_words;; ++i) {
+			assert(i < m_words);
+			const pack_type w = word(y, i);
+			if (const uint32 c = static_cast<uint32>(util::popcount(w)); r >= c) {
+				r -= c;
+			} else {
+				const uint64 pos = static_cast<uint64>(m_first_word + i) * pack_bits +
+				                   static_cast<uint64>(util::bit_select(w, static_cast<uint32>(r)));
+				return bit_point{static_cast<int32>(pos - BufferSize), y};
+			}
+		}
+	}
+	/// draw k cells with replacement to out
+	template <std::uniform_random_bit_generator Rng, std::output_iterator<bit_point> OutputIt>
+	OutputIt sample(Rng& rng, size_t k, OutputIt out) const
+	{
+		for (; k > 0; --k)
+			*out++ = sample(rng);
+		return out;
+	}
+
+private:
+	/// word i of the row from the first word holding a cell, masked to the sampled cells
+	pack_type word(int32 y, uint32 i) const noexcept
+	{
+		pack_type w = m_table->row_data(y)[m_first_word + i];
+		if (!m_set)
+			w = static_cast<pack_type>(~w);
+		const uint64 lo = static_cast<uint64>(m_first_word + i) * pack_bits;
+		const uint64 begin = BufferSize, end = BufferSize + m_table->getWidth();
+		if (lo < begin)
+			w &= static_cast<pack_type>(~util::make_mask<pack_type>(begin - lo));
+		if (lo + pack_bits > end)
+			w &= util::make_mask<pack_type>(end - lo);
+		return w;
+	}
+
+	const table_type* m_table;
+	bool m_set;
+	uint32 m_first_word = 0;
+	uint32 m_words = 0;
+	uint32 m_row_blocks = 0;
+	std::vector<uint64> m_prefix;
+};
+
+/**
+ * @brief Draw k set cells uniformly with replacement, empty if no cell is set.
+ * @see bit_sampler
+ */
+template <size_t BufferSize, std::unsigned_integral PackType, std::uniform_random_bit_generator Rng>
+std::vector<bit_point>
+sample_set(const bit_table<1, BufferSize, PackType>& table, Rng& rng, size_t k)
+{
+	std::vector<bit_point> res;
+	bit_sampler<BufferSize, PackType> sampler(table, true);
+	if (sampler.population() != 0) {
+		res.reserve(k);
+		sampler.sample(rng, k, std::back_inserter(res));
+	}
+	return res;
+}
+/**
+ * @brief Draw k clear cells uniformly with replacement, empty if every cell is set.
+ * @see bit_sampler
+ */
+template <size_t BufferSize, std::unsigned_integral PackType, std::uniform_random_bit_generator Rng>
+std::vector<bit_point>
+sample_clear(const bit_table<1, BufferSize, PackType>& table, Rng& rng, size_t k)
+{
+	std::vector<bit_point> res;
+	bit_sampler<BufferSize, PackType> sampler(table, false);
+	if (sampler.population() != 0) {
+		res.reserve(k);
+		sampler.sample(rng, k, std::back_inserter(res));
+	}
+	return res;
+}
+
+enum class fill_mode
+{
+	approx, ///< probability rounded to 8 binary digits, at most 8 random words per 64 cells
+	exact   ///< probability to 64 binary digits, about 8 random words per 64 cells on average
+};
+
+namespace details {
+/// @brief 64 cells each set with probability t/256, combining random words from the lowest digit of t
+inline uint64
+random_word_approx(util::xoshiro256& rng, uint32 t) noexcept
+{
+	assert(t != 0 && t < 256);
+	uint64 w = rng();
+	for (uint32 d = static_cast<uint32>(util::ctz(t)) + 1; d < 8; ++d)
+		w = (t >> d) & 1 ? w | rng() : w & rng();
+	return w;
+}
+/// @brief 64 cells each set if a uniform 64 bit fraction is below m / 2^64
+///
+/// The fractions are compared one binary digit at a time, msb first, across all 64 cells,
+/// stopping once every cell differs from m or the remaining digits of m are clear.
+inline uint64
+random_word_exact(util::xoshiro256& rng, uint64 m) noexcept
+{
+	assert(m != 0);
+	uint64 set = 0, undecided = ~uint64{0};
+	for (int d = 63; undecided != 0 && (m & util::make_mask<uint64>(d + 1)) != 0; --d) {
+		const uint64 r = rng();
+		if ((m >> d) & 1) {
+			set |= undecided & ~r;
+			undecided &= r;
+		} else {
+			undecided &= ~r;
+		}
+	}
+	return set;
+}
+} // namespace details
+
+/// rows of a random_fill band, each band has its own jumped random stream
+inline constexpr uint32 fill_band_rows = 64;
+
+/**
+ * @brief Set each cell of table independently with probability p, a word of cells at a time.
+ *
+ * Rows are split into bands of fill_band_rows, band i is generated from rng jumped i times,
+ * so the result only depends on rng and not threads. rng is left jumped once per band.
+ * Buffer cells are unchanged.
+ * @param threads number of threads to split the bands across
+ */
+template <size_t BufferSize, std::unsigned_integral PackType>
+void
+random_fill(bit_table<1, BufferSize, PackType>& table,
+            util::xoshiro256& rng,
+            double p,
+            fill_mode mode = fill_mode::approx,
+            uint32 threads = 1)
+{
+	constexpr uint32 pack_bits = sizeof(PackType) * CHAR_BIT;
+	const uint32 width = table.getWidth(), height = table.getHeight();
+	const uint32 bands = (height + fill_band_rows - 1) / fill_band_rows;
+	std::vector<util::xoshiro256> streams;
+	streams.reserve(bands);
+	for (uint32 i = 0; i < bands; ++i) {
+		streams.push_back(rng);
+		rng.jump();
+	}
+	// 0 for none, 1 for all, otherwise generated
+	int state = 2;
+	uint32 approx_t = 0;
+	uint64 exact_m = 0;
+	if (mode == fill_mode::approx) {
+		approx_t = static_cast<uint32>(std::lround(std::clamp(p, 0.0, 1.0) * 256));
+		state = approx_t == 0 ? 0 : approx_t == 256 ? 1 : 2;
+	} else {
+		if (!(p > 0))
+			state = 0;
+		else if (p >= 1)
+			state = 1;
+		else if ((exact_m = static_cast<uint64>(std::ldexp(p, 64))) == 0)
+			state = 0;
+	}
+
+	util::parallel_ranges(0, bands, threads, 1, [&](int64 b1, int64 b2) {
+		for (int64 b = b1; b < b2; ++b) {
+			util::xoshiro256& gen = streams[b];
+			const uint32 y2 = std::min(static_cast<uint32>(b + 1) * fill_band_rows, height);
+			for (uint32 y = static_cast<uint32>(b) * fill_band_rows; y < y2; ++y) {
+				PackType* row = table.row_data(static_cast<int32>(y));
+				for (uint32 x = 0; x < width; x += 64) {
+					uint64 w = state == 0 ? 0
+					         : state == 1 ? ~uint64{0}
+					         : mode == fill_mode::approx ? details::random_word_approx(gen, approx_t)
+					                                     : details::random_word_exact(gen, exact_m);
+					for (uint32 i = 0; i < 64 && x + i < width; i += pack_bits) {
+						details::bit_row_write<PackType>(row,
+						                                 static_cast<int64>(BufferSize + x + i),
+						                                 static_cast<PackType>(w >> i),
+						                                 util::make_mask<PackType>(std::min(pack_bits, width - x - i)));
+					}
+				}
+			}
+		}
+	});
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_RANDOM_HPP
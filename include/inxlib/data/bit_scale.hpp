@@ -0,0 +1,234 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_SCALE_HPP
+#define INXLIB_DATA_BIT_SCALE_HPP
+
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+enum class scale_reduce
+{
+	any,     ///< set if any cell of the block is set
+	all,     ///< set if every cell of the block is set
+	majority ///< set if more than half the cells of the block are set
+};
+
+namespace details {
+template <uint32 Factor, size_t SrcBuffer, size_t DestBuffer, std::unsigned_integral PackType>
+void
+downsample_impl(const bit_table<1, SrcBuffer, PackType>& src,
+                bit_table<1, DestBuffer, PackType>& dst,
+                scale_reduce reduce)
+{
+	constexpr uint32 pack_bits = sizeof(PackType) * CHAR_BIT;
+	static_assert(2 * Factor <= pack_bits, "factor too large for PackType");
+	constexpr uint32 out_bits = pack_bits / Factor;
+	constexpr uint32 lane = 2 * Factor; // majority counts are kept in lanes of two blocks
+	constexpr PackType lane_low = util::bit_stride_mask<PackType, 2>(Factor);
+	constexpr PackType lane_one = util::bit_stride_mask<PackType, lane>(1);
+	constexpr PackType lane_top = static_cast<PackType>(lane_one << (lane - 1));
+	// top bit of a lane is set once the count reaches a strict majority
+	constexpr PackType lane_bias = static_cast<PackType>(lane_one * ((1u << (lane - 1)) - (Factor * Factor / 2 + 1)));
+	const uint32 width = src.getWidth(), height = src.getHeight();
+	const uint32 dwidth = dst.getWidth(), dheight = dst.getHeight();
+	const int64 limit = static_cast<int64>(SrcBuffer) + width;
+
+	for (uint32 dy = 0; dy < dheight; ++dy) {
+		const uint32 y0 = dy * Factor, y1 = std::min(y0 + Factor, height);
+		PackType* drow = dst.row_data(static_cast<int32>(dy));
+		for (uint32 x = 0; x < width; x += pack_bits) {
+			const int64 pos = static_cast<int64>(SrcBuffer) + x;
+			PackType ans;
+			if (reduce == scale_reduce::majority) {
+				PackType even = 0, odd = 0;
+				for (uint32 y = y0; y < y1; ++y) {
+					PackType c = bit_row_read(src.row_data(static_cast<int32>(y)), pos, limit);
+					for (uint32 s = 1; s < Factor; s <<= 1) {
+						const PackType m = util::bit_stride_mask<PackType, 2>(s);
+						c = static_cast<PackType>((c & m) + ((c >> s) & m));
+					}
+					even += c & lane_low;
+					odd += (c >> Factor) & lane_low;
+				}
+				even = ((even + lane_bias) & lane_top) >> (lane - 1);
+				odd = ((odd + lane_bias) & lane_top) >> (lane - 1);
+				ans = util::bit_compact<Factor>(static_cast<PackType>(even | (odd << Factor)));
+			} else {
+				const bool all = reduce == scale_reduce::all;
+				// past the width reads as clear, so for all it is set
+				PackType pad = 0;
+				if (limit - pos < pack_bits)
+					pad = static_cast<PackType>(~util::make_mask<PackType>(static_cast<size_t>(limit - pos)));
+				PackType w = all ? static_cast<PackType>(~PackType{0}) : PackType{0};
+				for (uint32 y = y0; y < y1; ++y) {
+					PackType c = bit_row_read(src.row_data(static_cast<int32>(y)), pos, limit);
+					w = all ? w & (c | pad) : w | c;
+				}
+				for (uint32 s = 1; s < Factor; s <<= 1)
+					w = all ? w & (w >> s) : w | (w >> s);
+				ans = util::bit_compact<Factor>(w);
+			}
+			const uint32 dx = x / Factor;
+			bit_row_write(drow,
+			              static_cast<int64>(DestBuffer) + dx,
+			              ans,
+			              util::make_mask<PackType>(std::min(out_bits, dwidth - dx)));
+		}
+	}
+
+	// majority over the partial blocks at the edges counts only cells within src
+	if (reduce == scale_reduce::majority) {
+		auto fix_block = [&](uint32 dx, uint32 dy) {
+			const uint32 x1 = std::min((dx + 1) * Factor, width), y1 = std::min((dy + 1) * Factor, height);
+			uint32 count = 0;
+			for (uint32 y = dy * Factor; y < y1; ++y)
+				for (uint32 x = dx * Factor; x < x1; ++x)
+					count += static_cast<uint32>(src.bit_get(static_cast<int32>(x), static_cast<int32>(y)));
+			const uint32 cells = (x1 - dx * Factor) * (y1 - dy * Factor);
+			dst.bit_set(static_cast<int32>(dx), static_cast<int32>(dy), 2 * count > cells ? 1 : 0);
+		};
+		if (width % Factor != 0) {
+			for (uint32 dy = 0; dy < dheight; ++dy)
+				fix_block(dwidth - 1, dy);
+		}
+		if (height % Factor != 0) {
+			for (uint32 dx = 0; dx < dwidth; ++dx)
+				fix_block(dx, dheight - 1);
+		}
+	}
+}
+
+template <uint32 Factor, size_t SrcBuffer, size_t DestBuffer, std::unsigned_integral PackType>
+void
+upsample_impl(const bit_table<1, SrcBuffer, PackType>& src, bit_table<1, DestBuffer, PackType>& dst)
+{
+	constexpr uint32 pack_bits = sizeof(PackType) * CHAR_BIT;
+	static_assert(Factor < pack_bits, "factor too large for PackType");
+	const uint32 dwidth = dst.getWidth(), dheight = dst.getHeight();
+	const int64 limit = static_cast<int64>(SrcBuffer) + src.getWidth();
+
+	for (uint32 dy = 0; dy < dheight; dy += Factor) {
+		const PackType* srow = src.row_data(static_cast<int32>(dy / Factor));
+		PackType* drow = dst.row_data(static_cast<int32>(dy));
+		for (uint32 x = 0; x < dwidth; x += pack_bits) {
+			PackType w =
+			  util::bit_spread<Factor>(bit_row_read(srow, static_cast<int64>(SrcBuffer) + x / Factor, limit));
+			for (uint32 s = 1; s < Factor; s <<= 1)
+				w |= static_cast<PackType>(w << s);
+			bit_row_write(drow,
+			              static_cast<int64>(DestBuffer) + x,
+			              w,
+			              util::make_mask<PackType>(std::min(pack_bits, dwidth - x)));
+		}
+		// the remaining rows of the block repeat the first
+		for (uint32 y = dy + 1; y < std::min(dy + Factor, dheight); ++y)
+			bit_row_copy(dst.row_data(static_cast<int32>(y)),
+			             static_cast<int64>(DestBuffer),
+			             static_cast<const PackType*>(drow),
+			             static_cast<int64>(DestBuffer),
+			             static_cast<int64>(dwidth));
+	}
+}
+} // namespace details
+
+/**
+ * @brief Reduce each factor*factor block of src into one cell of dst, a word of cells at a time.
+ *
+ * Blocks are folded with shifted OR/AND (or SWAR block counts for majority) and gathered
+ * with bit_compact. Blocks at the edges only cover the cells within src.
+ * dst must be ceil(width/factor) by ceil(height/factor), its buffer is unchanged.
+ * @param factor 2, 4 or 8, 8 requires PackType of at least 16 bits
+ */
+template <size_t SrcBuffer, size_t DestBuffer, std::unsigned_integral PackType>
+void
+downsample(const bit_table<1, SrcBuffer, PackType>& src,
+           bit_table<1, DestBuffer, PackType>& dst,
+           uint32 factor,
+           scale_reduce reduce = scale_reduce::any)
+{
+	assert(factor != 0 && (src.getWidth() + factor - 1) / factor == dst.getWidth() &&
+	       (src.getHeight() + factor - 1) / factor == dst.getHeight());
+	switch (factor) {
+	case 1:
+		src.shift_into(dst, 0, 0);
+		break;
+	case 2:
+		details::downsample_impl<2>(src, dst, reduce);
+		break;
+	case 4:
+		details::downsample_impl<4>(src, dst, reduce);
+		break;
+	case 8:
+		if constexpr (sizeof(PackType) >= 2) {
+			details::downsample_impl<8>(src, dst, reduce);
+			break;
+		}
+		[[fallthrough]];
+	default:
+		assert(false);
+	}
+}
+
+/**
+ * @brief Expand each cell of src into a factor*factor block of dst, a word of cells at a time.
+ *
+ * Cells are expanded with bit_spread, and each block row after the first is copied from the first.
+ * dst dimensions divided by factor, rounding up, must match src, its buffer is unchanged.
+ * @param factor 2, 4 or 8, 8 requires PackType of at least 16 bits
+ */
+template <size_t SrcBuffer, size_t DestBuffer, std::unsigned_integral PackType>
+void
+upsample(const bit_table<1, SrcBuffer, PackType>& src, bit_table<1, DestBuffer, PackType>& dst, uint32 factor)
+{
+	assert(factor != 0 && (dst.getWidth() + factor - 1) / factor == src.getWidth() &&
+	       (dst.getHeight() + factor - 1) / factor == src.getHeight());
+	switch (factor) {
+	case 1:
+		src.shift_into(dst, 0, 0);
+		break;
+	case 2:
+		details::upsample_impl<2>(src, dst);
+		break;
+	case 4:
+		details::upsample_impl<4>(src, dst);
+		break;
+	case 8:
+		if constexpr (sizeof(PackType) >= 2) {
+			details::upsample_impl<8>(src, dst);
+			break;
+		}
+		[[fallthrough]];
+	default:
+		assert(false);
+	}
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_SCALE_HPP
@@ -0,0 +1,180 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_STATS_HPP
+#define INXLIB_DATA_BIT_STATS_HPP
+
+#include <algorithm>
+#include <array>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+namespace details {
+/// @brief Call fn(word, valid) for each word of cells in the region, valid masks the lanes within it
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType, typename Fn>
+void
+bit_region_words(const bit_table<BitCount, BufferSize, PackType>& table,
+                 int32 x,
+                 int32 y,
+                 int32 width,
+                 int32 height,
+                 Fn&& fn) noexcept
+{
+	using ops = bit_ops<BitCount, PackType>;
+	assert(width > 0 && height > 0);
+	assert(static_cast<uint32>(x) < table.getWidth() && static_cast<uint32>(x + width) <= table.getWidth());
+	assert(static_cast<uint32>(y) < table.getHeight() && static_cast<uint32>(y + height) <= table.getHeight());
+	const int64 pos = static_cast<int64>(BufferSize + x) << ops::bit_adj;
+	const int64 bits = static_cast<int64>(width) << ops::bit_adj;
+	for (int32 j = y; j < y + height; ++j) {
+		const PackType* row = table.row_data(j);
+		for (int64 i = 0; i < bits; i += ops::pack_bits) {
+			const size_t n = static_cast<size_t>(std::min<int64>(ops::pack_bits, bits - i));
+			fn(bit_row_read(row, pos + i, pos + bits), util::make_mask<PackType>(n));
+		}
+	}
+}
+
+/// @brief Lanes of a that are >= the same lane of b, as full lane masks. Lanes are 1 << bit_adj wide.
+template <size_t BitAdj, std::unsigned_integral PackType>
+constexpr PackType
+lane_ge(PackType a, PackType b) noexcept
+{
+	constexpr size_t lane = size_t{1} << BitAdj;
+	constexpr PackType high = static_cast<PackType>(util::bit_stride_mask<PackType, lane>(1) << (lane - 1));
+	// high bit of each lane of d compares the low bits, borrows stop at the set high bit
+	const PackType d = static_cast<PackType>((a | high) - (b & ~high));
+	const PackType ge = static_cast<PackType>(((a & ~b) | (~(a ^ b) & d)) & high);
+	return static_cast<PackType>((ge - (ge >> (lane - 1))) | ge);
+}
+} // namespace details
+
+/**
+ * @brief Count of each cell value in the width*height region at (x,y).
+ *
+ * For each value the cells are compared a word at a time, XOR-ing against the value in every
+ * lane and AND-folding each lane to a single bit to popcount. Tables with more values than
+ * cells per word count the lanes of each word instead.
+ */
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+std::array<uint64, (size_t{1} << BitCount)>
+region_histogram(const bit_table<BitCount, BufferSize, PackType>& table, int32 x, int32 y, int32 width, int32 height)
+{
+	using ops = details::bit_ops<BitCount, PackType>;
+	constexpr size_t values = size_t{1} << BitCount;
+	constexpr size_t lane = size_t{1} << ops::bit_adj;
+	std::array<uint64, values> res{};
+	if constexpr (values > ops::item_count) {
+		details::bit_region_words(table, x, y, width, height, [&res](PackType w, PackType valid) {
+			const size_t n = static_cast<size_t>(std::bit_width(valid)) >> ops::bit_adj;
+			for (size_t i = 0; i < n; ++i)
+				res[(static_cast<uint64>(w) >> (i * lane)) & ops::bit_mask] += 1;
+		});
+	} else {
+		constexpr PackType low = ops::fill_word(1);
+		details::bit_region_words(table, x, y, width, height, [&res](PackType w, PackType valid) {
+			for (size_t v = 0; v < values; ++v) {
+				PackType eq = static_cast<PackType>(~(w ^ ops::fill_word(static_cast<PackType>(v))));
+				for (size_t s = 1; s < lane; s <<= 1)
+					eq &= static_cast<PackType>(eq >> s);
+				res[v] += static_cast<uint64>(util::popcount(static_cast<PackType>(eq & low & valid)));
+			}
+		});
+	}
+	return res;
+}
+
+/**
+ * @brief Sum of the cell values in the width*height region at (x,y),
+ *        adding the popcount of each value bit plane scaled by its weight.
+ */
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+uint64
+region_sum(const bit_table<BitCount, BufferSize, PackType>& table, int32 x, int32 y, int32 width, int32 height) noexcept
+{
+	using ops = details::bit_ops<BitCount, PackType>;
+	std::array<uint64, BitCount> planes{};
+	details::bit_region_words(table, x, y, width, height, [&planes](PackType w, PackType) {
+		for (size_t b = 0; b < BitCount; ++b)
+			planes[b] += static_cast<uint64>(util::popcount(static_cast<PackType>(w & (ops::fill_word(1) << b))));
+	});
+	uint64 res = 0;
+	for (size_t b = 0; b < BitCount; ++b)
+		res += planes[b] << b;
+	return res;
+}
+
+/**
+ * @brief Smallest cell value in the width*height region at (x,y).
+ *
+ * Words are combined with a SWAR lane-wise min, cells outside the region compare as bit_mask,
+ * leaving a single word whose lanes are reduced at the end.
+ */
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+PackType
+region_min(const bit_table<BitCount, BufferSize, PackType>& table, int32 x, int32 y, int32 width, int32 height) noexcept
+{
+	using ops = details::bit_ops<BitCount, PackType>;
+	constexpr PackType top = ops::fill_word(ops::bit_mask);
+	PackType acc = top;
+	details::bit_region_words(table, x, y, width, height, [&acc](PackType w, PackType valid) {
+		w = static_cast<PackType>(w | (top & ~valid));
+		const PackType ge = details::lane_ge<ops::bit_adj>(acc, w);
+		acc = static_cast<PackType>((w & ge) | (acc & ~ge));
+	});
+	PackType res = ops::bit_mask;
+	for (size_t i = 0; i < ops::item_count; ++i)
+		res = std::min<PackType>(res, (static_cast<uint64>(acc) >> (i << ops::bit_adj)) & ops::bit_mask);
+	return res;
+}
+
+/**
+ * @brief Largest cell value in the width*height region at (x,y).
+ *
+ * Words are combined with a SWAR lane-wise max, cells outside the region compare as 0,
+ * leaving a single word whose lanes are reduced at the end.
+ */
+template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+PackType
+region_max(const bit_table<BitCount, BufferSize, PackType>& table, int32 x, int32 y, int32 width, int32 height) noexcept
+{
+	using ops = details::bit_ops<BitCount, PackType>;
+	PackType acc = 0;
+	details::bit_region_words(table, x, y, width, height, [&acc](PackType w, PackType) {
+		const PackType ge = details::lane_ge<ops::bit_adj>(acc, w);
+		acc = static_cast<PackType>((acc & ge) | (w & ~ge));
+	});
+	PackType res = 0;
+	for (size_t i = 0; i < ops::item_count; ++i)
+		res = std::max<PackType>(res, (static_cast<uint64>(acc) >> (i << ops::bit_adj)) & ops::bit_mask);
+	return res;
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_STATS_HPP
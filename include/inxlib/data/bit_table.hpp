@@ -25,18 +25,167 @@ SOFTWARE.
 #ifndef INXLIB_DATA_BIT_TABLE_HPP
 #define INXLIB_DATA_BIT_TABLE_HPP
 
+#include <algorithm>
+#include <array>
 #include <cstring>
 #include <inxlib/inx.hpp>
 #include <inxlib/util/bits.hpp>
-#ifndef NDEBUG
-#include <vector>
-#endif
+#include <limits>
 #include <memory>
 #include <memory_resource>
+#include <vector>
 
 namespace inx::data {
 
+/// rectangle of cells, empty if width or height is 0
+struct bit_rect
+{
+	int32 x, y, width, height;
+	bool empty() const noexcept { return width <= 0 || height <= 0; }
+	bool operator==(const bit_rect&) const noexcept = default;
+};
+
+/// coordinate of a cell
+struct bit_point
+{
+	int32 x, y;
+	bool operator==(const bit_point&) const noexcept = default;
+};
+
+template <size_t BitCount, std::unsigned_integral PackType>
+class bit_cell;
+
 namespace details {
+/// @brief Read a full word of bits starting at bit offset pos of a row.
+///        Bits before the row and bits at or after limit read as 0.
+template <std::unsigned_integral PackType>
+PackType
+bit_row_read(const PackType* row, int64 pos, int64 limit) noexcept
+{
+	constexpr int64 pack_bits = sizeof(PackType) * CHAR_BIT;
+	constexpr size_t pack_bits_size = std::bit_width(static_cast<size_t>(pack_bits - 1));
+	if (pos >= limit || pos <= -pack_bits)
+		return 0;
+	int64 word = pos >> pack_bits_size;
+	uint32 bit = static_cast<uint32>(pos & (pack_bits - 1));
+	int64 last = (limit - 1) >> pack_bits_size;
+	PackType lo = word >= 0 ? row[word] : 0;
+	PackType ans;
+	if (bit == 0) {
+		ans = lo;
+	} else {
+		PackType hi = word < last ? row[word + 1] : 0;
+		ans = static_cast<PackType>(util::bit_right_shift<PackType>(lo, bit) |
+		                            util::bit_left_shift<PackType>(hi, pack_bits - bit));
+	}
+	if (limit - pos < pack_bits)
+		ans &= util::make_mask<PackType>(static_cast<size_t>(limit - pos));
+	return ans;
+}
+
+/// @brief Write the bits of value selected by mask at bit offset pos of a row, pos >= 0.
+template <std::unsigned_integral PackType>
+void
+bit_row_write(PackType* row, int64 pos, PackType value, PackType mask) noexcept
+{
+	constexpr size_t pack_bits = sizeof(PackType) * CHAR_BIT;
+	constexpr size_t pack_bits_size = std::bit_width(pack_bits - 1);
+	assert(pos >= 0);
+	row += pos >> pack_bits_size;
+	uint32 bit = static_cast<uint32>(pos & (pack_bits - 1));
+	value &= mask;
+	row[0] = (row[0] & ~util::bit_left_shift<PackType>(mask, bit)) | util::bit_left_shift<PackType>(value, bit);
+	if (bit != 0) {
+		if (PackType hmask = util::bit_right_shift<PackType>(mask, pack_bits - bit); hmask != 0) {
+			row[1] = (row[1] & ~hmask) | util::bit_right_shift<PackType>(value, pack_bits - bit);
+		}
+	}
+}
+
+/// @brief Fill bits [pos, pos+count) of a row with the matching bits of fill, pos >= 0.
+template <std::unsigned_integral PackType>
+void
+bit_row_fill(PackType* row, int64 pos, int64 count, PackType fill) noexcept
+{
+	constexpr size_t pack_bits = sizeof(PackType) * CHAR_BIT;
+	constexpr size_t pack_bits_size = std::bit_width(pack_bits - 1);
+	assert(pos >= 0 && count >= 0);
+	if (count == 0)
+		return;
+	row += pos >> pack_bits_size;
+	uint32 bit = static_cast<uint32>(pos & (pack_bits - 1));
+	if (bit + count <= static_cast<int64>(pack_bits)) {
+		PackType mask = util::make_mask<PackType>(static_cast<size_t>(count), bit);
+		*row = (*row & ~mask) | (fill & mask);
+		return;
+	}
+	if (bit != 0) {
+		PackType mask = util::make_mask<PackType>(pack_bits - bit, bit);
+		*row = (*row & ~mask) | (fill & mask);
+		++row;
+		count -= pack_bits - bit;
+	}
+	int64 words = count >> pack_bits_size;
+	std::fill_n(row, words, fill);
+	row += words;
+	if (uint32 rem = static_cast<uint32>(count & (pack_bits - 1)); rem != 0) {
+		PackType mask = util::make_mask<PackType>(rem);
+		*row = (*row & ~mask) | (fill & mask);
+	}
+}
+
+/// @brief Copy count bits of src at spos to dst at dpos, spos,dpos >= 0.
+///        Ranges may overlap, as with memmove.
+template <std::unsigned_integral PackType>
+void
+bit_row_copy(PackType* dst, int64 dpos, const PackType* src, int64 spos, int64 count) noexcept
+{
+	constexpr int64 pack_bits = sizeof(PackType) * CHAR_BIT;
+	constexpr size_t pack_bits_size = std::bit_width(static_cast<size_t>(pack_bits - 1));
+	assert(dpos >= 0 && spos >= 0 && count >= 0);
+	if (count == 0)
+		return;
+	const int64 head = std::min((pack_bits - (dpos & (pack_bits - 1))) & (pack_bits - 1), count);
+	const int64 words = (count - head) >> pack_bits_size;
+	const int64 tail = count - head - (words << pack_bits_size);
+	const int64 slimit = spos + count;
+	if (((dpos ^ spos) & (pack_bits - 1)) == 0) {
+		// same offset within a word, whole words are moved directly
+		PackType hv = head != 0 ? bit_row_read(src, spos, slimit) : 0;
+		PackType tv = tail != 0 ? bit_row_read(src, slimit - tail, slimit) : 0;
+		std::memmove(dst + ((dpos + head) >> pack_bits_size),
+		             src + ((spos + head) >> pack_bits_size),
+		             static_cast<size_t>(words) * sizeof(PackType));
+		if (head != 0)
+			bit_row_write(dst, dpos, hv, util::make_mask<PackType>(static_cast<size_t>(head)));
+		if (tail != 0)
+			bit_row_write(dst, dpos + count - tail, tv, util::make_mask<PackType>(static_cast<size_t>(tail)));
+		return;
+	}
+	// funnel each dst word from two src words, ordered so src is read before it is overwritten
+	auto part = [=](int64 at, int64 n) noexcept {
+		bit_row_write(
+		  dst, at, bit_row_read(src, spos + (at - dpos), slimit), util::make_mask<PackType>(static_cast<size_t>(n)));
+	};
+	PackType* dw = dst + ((dpos + head) >> pack_bits_size);
+	const int64 sw = spos + head;
+	if (dpos < spos) {
+		if (head != 0)
+			part(dpos, head);
+		for (int64 i = 0; i < words; ++i)
+			dw[i] = bit_row_read(src, sw + (i << pack_bits_size), slimit);
+		if (tail != 0)
+			part(dpos + count - tail, tail);
+	} else {
+		if (tail != 0)
+			part(dpos + count - tail, tail);
+		for (int64 i = words; i-- > 0;)
+			dw[i] = bit_row_read(src, sw + (i << pack_bits_size), slimit);
+		if (head != 0)
+			part(dpos, head);
+	}
+}
+
 template <size_t BitCount, std::unsigned_integral PackType>
     requires(!std::same_as<PackType, bool>)
 class bit_ops
@@ -59,6 +208,13 @@ public:
 	static constexpr pack_type pack_mask = util::make_mask<pack_type, pack_size>();
 	static constexpr size_t item_count = (1 << pack_size);
 
+	/// word with every cell set to value
+	static constexpr pack_type fill_word(pack_type value) noexcept
+	{
+		assert(value <= bit_mask);
+		return static_cast<pack_type>(util::bit_stride_mask<pack_type, (1 << bit_adj)>(1) * value);
+	}
+
 	enum class op
 	{
 		OR,
@@ -165,6 +321,104 @@ protected:
 		}
 	}
 
+	/**
+	 * @brief Tight bounds of the set cells of the width*height region at (x,y), starting at bit pos
+	 *        with rows row_bits apart. Each row is scanned from the left to its first non-zero word
+	 *        and from the right to its last, giving its lowest and highest set bit with ctz and bit_width.
+	 */
+	static bit_rect bounds(const pack_type* data,
+	                       int64 pos,
+	                       int64 row_bits,
+	                       int32 x,
+	                       int32 y,
+	                       int32 width,
+	                       int32 height) noexcept
+	{
+		const int64 bits = static_cast<int64>(width) << bit_adj;
+		const int64 chunks = (bits + pack_bits - 1) >> pack_bits_size;
+		int32 y1 = -1, y2 = -1;
+		int64 lo = bits, hi = -1; // lowest and highest set bit of any row
+		for (int32 r = 0; r < height; ++r, pos += row_bits) {
+			auto read = [&](int64 j) noexcept { return bit_row_read(data, pos + (j << pack_bits_size), pos + bits); };
+			int64 j1 = 0;
+			pack_type v1 = 0;
+			for (; j1 < chunks && (v1 = read(j1)) == 0; ++j1)
+				;
+			if (j1 == chunks)
+				continue;
+			if (y1 < 0)
+				y1 = r;
+			y2 = r;
+			lo = std::min(lo, (j1 << pack_bits_size) + static_cast<int64>(util::ctz(v1)));
+			int64 j2 = chunks - 1;
+			pack_type v2;
+			while ((v2 = read(j2)) == 0)
+				--j2;
+			hi = std::max(hi, (j2 << pack_bits_size) + static_cast<int64>(std::bit_width(v2)) - 1);
+		}
+		if (y1 < 0)
+			return {x, y, 0, 0};
+		const int32 c1 = static_cast<int32>(lo >> bit_adj);
+		const int32 c2 = static_cast<int32>(hi >> bit_adj);
+		return {x + c1, y + y1, c2 - c1 + 1, y2 - y1 + 1};
+	}
+
+	/**
+	 * @brief Shift a width*height region of src by (dx,dy) into dst, uncovered cells are set to value.
+	 *        Regions start at bit origin with rows row_bits apart, and may be the same region.
+	 */
+	static void shift(pack_type* dst,
+	                  int64 dst_origin,
+	                  int64 dst_row_bits,
+	                  const pack_type* src,
+	                  int64 src_origin,
+	                  int64 src_row_bits,
+	                  uint32 width,
+	                  uint32 height,
+	                  int32 dx,
+	                  int32 dy,
+	                  pack_type value) noexcept
+	{
+		const pack_type fill = fill_word(value);
+		const int64 row_bits = static_cast<int64>(width) << bit_adj;
+		const int64 adx = dx < 0 ? -static_cast<int64>(dx) : dx;
+		const int64 ady = dy < 0 ? -static_cast<int64>(dy) : dy;
+		if (adx >= width || ady >= height) {
+			for (uint32 y = 0; y < height; ++y)
+				bit_row_fill(dst, dst_origin + y * dst_row_bits, row_bits, fill);
+			return;
+		}
+		if (dx == 0 && dst_row_bits == row_bits && src_row_bits == row_bits) {
+			// contiguous rows move as a single span
+			const int64 keep = (height - ady) * row_bits;
+			const int64 gap = ady * row_bits;
+			bit_row_copy(dst, dst_origin + (dy > 0 ? gap : 0), src, src_origin + (dy < 0 ? gap : 0), keep);
+			bit_row_fill(dst, dst_origin + (dy > 0 ? 0 : keep), gap, fill);
+			return;
+		}
+		const int64 keep = row_bits - (adx << bit_adj);
+		const int64 dcol = dx > 0 ? adx << bit_adj : 0;
+		const int64 scol = dx < 0 ? adx << bit_adj : 0;
+		auto shift_row = [&](int64 y) noexcept {
+			const int64 pos = dst_origin + y * dst_row_bits;
+			const int64 sy = y - dy;
+			if (sy < 0 || sy >= height) {
+				bit_row_fill(dst, pos, row_bits, fill);
+				return;
+			}
+			bit_row_copy(dst, pos + dcol, src, src_origin + sy * src_row_bits + scol, keep);
+			bit_row_fill(dst, dx > 0 ? pos : pos + keep, adx << bit_adj, fill);
+		};
+		// rows are visited so a source row is read before it is overwritten
+		if (dy > 0) {
+			for (int64 y = height; y-- > 0;)
+				shift_row(y);
+		} else {
+			for (int64 y = 0; y < height; ++y)
+				shift_row(y);
+		}
+	}
+
 	template <typename BT2>
 	    requires std::derived_from<BT2, bit_ops<BitCount, typename BT2::pack_type>>
 	static void region_op(op OP,
@@ -255,48 +509,48 @@ protected:
 
 	static pack_type bit_get(const pack_type* data, index_t id) noexcept
 	{
-		return bit_right_shift<pack_type>(data[id.word()], id.bit()) & bit_mask;
+		return util::bit_right_shift<pack_type>(data[id.word()], id.bit()) & bit_mask;
 	}
 	template <size_t I = 0>
 	static bool bit_test(const pack_type* data, index_t id) noexcept
 	{
-		return static_cast<bool>(bit_right_shift<pack_type>(data[id.word()], id.bit() + I) & 1);
+		return static_cast<bool>(util::bit_right_shift<pack_type>(data[id.word()], id.bit() + I) & 1);
 	}
 	static void bit_set(pack_type* data, index_t id, pack_type value) noexcept
 	{
 		assert(value <= bit_mask);
-		data[id.word()] = (data[id.word()] & ~bit_left_shift<pack_type>(bit_mask, id.bit())) |
-		                  bit_left_shift<pack_type>(value & bit_mask, id.bit());
+		data[id.word()] = (data[id.word()] & ~util::bit_left_shift<pack_type>(bit_mask, id.bit())) |
+		                  util::bit_left_shift<pack_type>(value & bit_mask, id.bit());
 	}
 	static void bit_clear(pack_type* data, index_t id) noexcept
 	{
-		data[id.word()] &= ~bit_left_shift<pack_type>(bit_mask, id.bit());
+		data[id.word()] &= ~util::bit_left_shift<pack_type>(bit_mask, id.bit());
 	}
 	static void bit_or(pack_type* data, index_t id, pack_type value) noexcept
 	{
 		assert(value <= bit_mask);
-		data[id.word()] |= bit_left_shift<pack_type>(value & bit_mask, id.bit());
+		data[id.word()] |= util::bit_left_shift<pack_type>(value & bit_mask, id.bit());
 	}
 	static void bit_and(pack_type* data, index_t id, pack_type value) noexcept
 	{
 		assert(value <= bit_mask);
-		data[id.word()] &= ~bit_left_shift<pack_type>((~value) & bit_mask, id.bit());
+		data[id.word()] &= ~util::bit_left_shift<pack_type>((~value) & bit_mask, id.bit());
 	}
 	static void bit_xor(pack_type* data, index_t id, pack_type value) noexcept
 	{
 		assert(value <= bit_mask);
-		data[id.word()] ^= bit_left_shift<pack_type>(value & bit_mask, id.bit());
+		data[id.word()] ^= util::bit_left_shift<pack_type>(value & bit_mask, id.bit());
 	}
 	static void bit_nand(pack_type* data, index_t id, pack_type value) noexcept
 	{
 		assert(value <= bit_mask);
 		data += id.word();
-		*data &= ~bit_left_shift<pack_type>((~value) & bit_mask, id.bit());
-		*data ^= bit_left_shift<pack_type>(bit_mask, id.bit());
+		*data &= ~util::bit_left_shift<pack_type>((~value) & bit_mask, id.bit());
+		*data ^= util::bit_left_shift<pack_type>(bit_mask, id.bit());
 	}
 	static void bit_not(pack_type* data, index_t id) noexcept
 	{
-		data[id.word()] ^= bit_left_shift<pack_type>(bit_mask, id.bit());
+		data[id.word()] ^= util::bit_left_shift<pack_type>(bit_mask, id.bit());
 	}
 
 	static pack_type word_get(const pack_type* data, index_t id) noexcept { return data[id.word()]; }
@@ -317,19 +571,19 @@ protected:
 			if (bit + (W<<bit_adj) > pack_bits) { // split bits
 				uint32 w1count = pack_bits - bit;
 				pack_type w2mask = util::make_mask<pack_type>((W << bit_adj) - w1count);
-				pack_type ans = bit_right_shift<pack_type>(mCells[word], bit) | bit_left_shift<pack_type>(mCells[word+1] & w2mask, w1count);
+				pack_type ans = util::bit_right_shift<pack_type>(mCells[word], bit) | util::bit_left_shift<pack_type>(mCells[word+1] & w2mask, w1count);
 				for (uint32 i = W << bit_adj; i < static_cast<uint32>(H * (W<<bit_adj)); i += W << bit_adj) {
 					word += mRowWords;
-					ans |= bit_left_shift<pack_type>(bit_right_shift<pack_type>(mCells[word], bit) | bit_left_shift<pack_type>(mCells[word+1] & w2mask, w1count), i);
+					ans |= util::bit_left_shift<pack_type>(util::bit_right_shift<pack_type>(mCells[word], bit) | util::bit_left_shift<pack_type>(mCells[word+1] & w2mask, w1count), i);
 				}
 
 				return ans;
 			} else {
 				pack_type w1mask = util::make_mask<pack_type>(W << bit_adj);
-				pack_type ans = bit_right_shift<pack_type>(mCells[word], bit) & w1mask;
+				pack_type ans = util::bit_right_shift<pack_type>(mCells[word], bit) & w1mask;
 				for (uint32 i = W << bit_adj; i < static_cast<uint32>(H * (W<<bit_adj)); i += W << bit_adj) {
 					word += mRowWords;
-					ans |= bit_left_shift<pack_type>(bit_right_shift<pack_type>(mCells[word], bit) & w1mask, i);
+					ans |= util::bit_left_shift<pack_type>(util::bit_right_shift<pack_type>(mCells[word], bit) & w1mask, i);
 				}
 
 				return ans;
@@ -343,16 +597,16 @@ protected:
 		}
 #else
 		if constexpr (W == 1 && H == 1) {
-			return bit_get(id);
+			return bit_get(data, id);
 		} else {
 			auto word = id.word();
 			auto bit = id.bit();
 			if constexpr (W == 1) {
 				const auto* cell = data + word;
-				pack_type ans = bit_right_shift<pack_type>(*cell, bit) & bit_mask;
+				pack_type ans = util::bit_right_shift<pack_type>(*cell, bit) & bit_mask;
 				for (size_t i = bit_count; i < bit_count * static_cast<size_t>(H); i += bit_count) {
 					cell += row_words;
-					ans |= bit_shift_to<i>(*cell, bit) & bit_left_shift<i>(bit_mask);
+					ans |= util::bit_left_shift<pack_type>(util::bit_right_shift<pack_type>(*cell, bit) & bit_mask, i);
 				}
 				return ans;
 			} else if constexpr (std::endian::native == std::endian::little &&
@@ -372,18 +626,18 @@ protected:
 					cell += row_words;
 					size_t tmp;
 					std::memcpy(&tmp, cell, sizeof(size_t));
-					ans |= bit_shift_from_to(tmp, bit, i) & util::make_mask<pack_type>(bit_row, i);
+					ans |= util::bit_shift_from_to(tmp, bit, i) & util::make_mask<pack_type>(bit_row, i);
 				}
 				return static_cast<pack_type>(ans);
 			} else {
 				// TODO: not done
 				assert(false);
 				// const auto* cell = data() + word;
-				// pack_type ans = bit_right_shift<pack_type>(*cell, bit) &
+				// pack_type ans = util::bit_right_shift<pack_type>(*cell, bit) &
 				// bit_mask; for (size_t i = bit_count; i <
 				// bit_count*static_cast<size_t>(H); i += bit_count) { 	cell +=
-				// row; 	ans |= bit_shift_to<i>(*cell, bit) &
-				// bit_left_shift<i>(bit_mask);
+				// row; 	ans |= util::bit_shift_to<i>(*cell, bit) &
+				// util::bit_left_shift<i>(bit_mask);
 				// }
 				return {};
 			}
@@ -391,6 +645,12 @@ protected:
 #endif
 	}
 };
+
+/// base of lazy bit expressions, see bit_expr.hpp
+struct bit_expr_tag
+{};
+template <typename Table>
+class bit_expr_shift;
 } // namespace details
 
 template <size_t BitCount = 1, size_t BufferSize = 0, std::unsigned_integral PackType = size_t>
@@ -405,14 +665,29 @@ public:
 	static constexpr size_t buffer_size = BufferSize;
 	using size_type = size_t;
 
+	/// alignment of allocated cells, a cache line
+	static constexpr size_t cells_alignment = 64;
+
 	struct CellsData
 	{
 		CellsData() noexcept
 		  : cells(nullptr)
+		  , capacity(0)
+		  , align(cells_alignment)
+		  , res(std::pmr::get_default_resource())
+		{
+		}
+		CellsData(std::pmr::memory_resource* l_res) noexcept
+		  : cells(nullptr)
+		  , capacity(0)
+		  , align(cells_alignment)
+		  , res(l_res != nullptr ? l_res : std::pmr::get_default_resource())
 		{
 		}
 		pack_type* cells;
-		std::unique_ptr<pack_type[]> cells_data;
+		size_t capacity; ///< words owned by res, 0 if cells is not owned
+		size_t align;    ///< alignment cells were allocated with
+		std::pmr::memory_resource* res;
 	};
 
 public:
@@ -420,32 +695,102 @@ public:
 	  : mWidth(0)
 	  , mHeight(0)
 	  , mRowWords(0)
+	  , mRowAlign(1)
+	{
+	}
+	explicit bit_table(std::pmr::memory_resource* res) noexcept
+	  : mWidth(0)
+	  , mHeight(0)
+	  , mRowWords(0)
+	  , mRowAlign(1)
+	  , mCells(res)
 	{
 	}
-	bit_table(uint32 width, uint32 height) { setup(width, height); }
-	bit_table(bit_table&&) = default;
+	bit_table(uint32 width, uint32 height, std::pmr::memory_resource* res = nullptr)
+	  : bit_table(res)
+	{
+		setup(width, height);
+	}
+	bit_table(bit_table&& other) noexcept
+	  : mWidth(std::exchange(other.mWidth, 0))
+	  , mHeight(std::exchange(other.mHeight, 0))
+	  , mRowWords(std::exchange(other.mRowWords, 0))
+	  , mRowAlign(other.mRowAlign)
+	  , mCells(std::exchange(other.mCells, CellsData(other.mCells.res)))
+	{
+	}
+	/// copies use the default memory resource, as with std::pmr containers
 	bit_table(const bit_table& other)
+	  : bit_table(other, nullptr)
+	{
+	}
+	bit_table(const bit_table& other, std::pmr::memory_resource* res)
+	  : bit_table(res)
+	{
+		setup(other);
+	}
+	~bit_table() { release_cells(); }
+
+	/// steals the cells when both tables share a memory resource, otherwise copies
+	bit_table& operator=(bit_table&& other)
+	{
+		if (this != &other) {
+			if (mCells.res == other.mCells.res || *mCells.res == *other.mCells.res || other.mCells.capacity == 0) {
+				release_cells();
+				mWidth = std::exchange(other.mWidth, 0);
+				mHeight = std::exchange(other.mHeight, 0);
+				mRowWords = std::exchange(other.mRowWords, 0);
+				mRowAlign = other.mRowAlign;
+				mCells.cells = std::exchange(other.mCells.cells, nullptr);
+				mCells.capacity = std::exchange(other.mCells.capacity, 0);
+				mCells.align = other.mCells.align;
+			} else {
+				setup(other);
+			}
+		}
+		return *this;
+	}
+	/// reuses the allocated cells if large enough
+	bit_table& operator=(const bit_table& other)
+	{
+		if (this != &other)
+			setup(other);
+		return *this;
+	}
+	/// evaluate a bit expression into the table cells in one pass, the buffer is unchanged, see bit_expr.hpp
+	template <typename Expr>
+	    requires std::derived_from<Expr, details::bit_expr_tag>
+	bit_table& operator=(const Expr& expr)
+	{
+		bit_expr_assign(*this, expr);
+		return *this;
+	}
+
+	std::pmr::memory_resource* get_resource() const noexcept { return mCells.res; }
+
+	/**
+	 * @brief Align each row to align bytes, applied on the next setup/resize.
+	 *        align must be a power of 2, e.g. cells_alignment for cache line rows or 4096 for page rows.
+	 */
+	void set_row_alignment(size_t align) noexcept
 	{
-		mWidth = other.mWidth;
-		mHeight = other.mHeight;
-		mRowWords = other.mRowWords;
-		size_t words = (mHeight + 2 * buffer_size) * mRowWords;
-		mCells.cells_data = std::make_unique<pack_type[]>(words);
-		mCells.cells = mCells.cells_data.get();
-		std::uninitialized_copy_n(other.mCells.cells, words, mCells.cells);
+		assert(std::has_single_bit(align));
+		mRowAlign = static_cast<uint32>(std::max<size_t>(align / sizeof(pack_type), 1));
 	}
-	bit_table& operator=(bit_table&&) = default;
-	bit_table& operator=(const bit_table&) = delete;
+	size_t get_row_alignment() const noexcept { return mRowAlign * sizeof(pack_type); }
 
 	void setup(const bit_table& copy_from)
 	{
+		mRowAlign = copy_from.mRowAlign;
+		if (copy_from.mCells.cells == nullptr) {
+			clear();
+			return;
+		}
 		mWidth = copy_from.mWidth;
 		mHeight = copy_from.mHeight;
 		mRowWords = copy_from.mRowWords;
-		mCells.cells_data = std::make_unique<pack_type[]>((mHeight + 2 * buffer_size) * mRowWords);
-		mCells.cells = mCells.cells_data.get();
-		const auto id = bit_adj_index(-static_cast<int32>(buffer_size), -static_cast<int32>(buffer_size));
-		copy_from.super::copy(mWidth + 2 * buffer_size, mHeight + 2 * buffer_size, copy_from.data(), id, *this, id);
+		reserve_cells(calc_cells_words());
+		std::memcpy(mCells.cells, copy_from.mCells.cells, calc_cells_words() * sizeof(pack_type));
 	}
 	void setup(uint32 width, uint32 height)
 	{
@@ -453,22 +798,82 @@ public:
 		assert(height > 0);
 		mWidth = width;
 		mHeight = height;
-		mRowWords = static_cast<uint32>(
-		  -(-static_cast<int32>(static_cast<pack_type>(width + 2 * buffer_size)) >> super::pack_size) + 1);
-		mCells.cells_data = std::make_unique<pack_type[]>((mHeight + 2 * buffer_size) * mRowWords);
-		mCells.cells = mCells.cells_data.get();
+		mRowWords = calc_row_words(width);
+		reserve_cells(calc_cells_words());
+		std::memset(mCells.cells, 0, calc_cells_words() * sizeof(pack_type));
 	}
 	void setup(uint32 width, uint32 height, pack_type* data)
 	{
 		assert(width > 0);
 		assert(height > 0);
+		release_cells();
 		mWidth = width;
 		mHeight = height;
-		mRowWords = static_cast<uint32>(
-		  -(-static_cast<int32>(static_cast<pack_type>(width + 2 * buffer_size)) >> super::pack_size) + 1);
-		mCells.cells_data = nullptr;
+		mRowWords = calc_row_words(width);
 		mCells.cells = data;
 	}
+
+	/**
+	 * @brief Resize to width and height, reusing the allocated cells if large enough.
+	 *        If keep_contents, cells within both the old and new dimensions are kept, all other
+	 *        cells including the buffer are zero. Otherwise all cells are zero.
+	 */
+	void resize(uint32 width, uint32 height, bool keep_contents = true)
+	{
+		assert(width > 0);
+		assert(height > 0);
+		if (!keep_contents || mCells.cells == nullptr) {
+			setup(width, height);
+			return;
+		}
+		const uint32 row_words = calc_row_words(width);
+		const size_t words = (height + 2 * buffer_size) * static_cast<size_t>(row_words);
+		// cells keep their bit position in a row, only the row stride changes
+		const size_t keep_words = std::min<size_t>(
+		  (((std::min(mWidth, width) + buffer_size) << super::bit_adj) + super::pack_bits - 1) >> super::pack_bits_size,
+		  std::min(mRowWords, row_words));
+		const size_t keep_bits = (std::min(mWidth, width) + buffer_size) << super::bit_adj;
+		const size_t rows = std::min(mHeight, height);
+		auto move_row = [&](pack_type* dst, const pack_type* src) noexcept {
+			std::memmove(dst, src, keep_words * sizeof(pack_type));
+			std::fill(dst + keep_words, dst + row_words, pack_type{0});
+			details::bit_row_fill<pack_type>(dst, keep_bits, (keep_words << super::pack_bits_size) - keep_bits, 0);
+			details::bit_row_fill<pack_type>(dst, 0, buffer_size << super::bit_adj, 0);
+		};
+		if (words <= mCells.capacity && mRowAlign * sizeof(pack_type) <= mCells.align) {
+			pack_type* cells = mCells.cells;
+			if (row_words <= mRowWords) {
+				for (size_t i = buffer_size; i < buffer_size + rows; ++i)
+					move_row(cells + i * row_words, cells + i * mRowWords);
+			} else {
+				for (size_t i = buffer_size + rows; i-- > buffer_size;)
+					move_row(cells + i * row_words, cells + i * mRowWords);
+			}
+			std::memset(cells, 0, buffer_size * row_words * sizeof(pack_type));
+			std::memset(
+			  cells + (buffer_size + rows) * row_words, 0, (words - (buffer_size + rows) * row_words) * sizeof(pack_type));
+		} else {
+			const size_t align = std::max(cells_alignment, mRowAlign * sizeof(pack_type));
+			auto* cells = static_cast<pack_type*>(mCells.res->allocate(words * sizeof(pack_type), align));
+			std::memset(cells, 0, words * sizeof(pack_type));
+			for (size_t i = buffer_size; i < buffer_size + rows; ++i)
+				move_row(cells + i * row_words, mCells.cells + i * mRowWords);
+			release_cells();
+			mCells.cells = cells;
+			mCells.capacity = words;
+			mCells.align = align;
+		}
+		mWidth = width;
+		mHeight = height;
+		mRowWords = row_words;
+	}
+
+	/// number of words in a row of width cells, including buffer and a trailing word
+	uint32 calc_row_words(uint32 width) const noexcept
+	{
+		uint32 words = static_cast<uint32>(((width + 2 * buffer_size + super::item_count - 1) >> super::pack_size) + 1);
+		return (words + mRowAlign - 1) & ~(mRowAlign - 1);
+	}
 	size_t calc_cells_words() const noexcept { return (mHeight + 2 * buffer_size) * mRowWords; }
 
 	pack_type bit_get(int32 x, int32 y) const noexcept { return bit_get(bit_index(x, y)); }
@@ -487,20 +892,70 @@ public:
 	void set_buffer(pack_type value) noexcept
 	{
 		if constexpr (BufferSize != 0) {
-			for (int32 i = -static_cast<int32>(BufferSize), j = static_cast<int32>(mHeight); i < 0; i++, j++)
-				for (int32 x = -static_cast<int32>(BufferSize),
-				           xe = x + static_cast<int32>(mWidth) + static_cast<int32>(2 * BufferSize);
-				     x < xe;
-				     ++x) {
-					bit_set(x, i, value);
-					bit_set(x, j, value);
+			constexpr int64 buffer_bits = static_cast<int64>(BufferSize) << super::bit_adj;
+			const pack_type fill = super::fill_word(value);
+			const int64 pad_bits = static_cast<int64>(getPadWidth()) << super::bit_adj;
+			// top and bottom buffer rows are filled whole
+			for (int32 i = -static_cast<int32>(BufferSize), j = static_cast<int32>(mHeight); i < 0; i++, j++) {
+				details::bit_row_fill(row_data(i), 0, pad_bits, fill);
+				details::bit_row_fill(row_data(j), 0, pad_bits, fill);
+			}
+			// left and right columns share the same word masks on every row
+			constexpr size_t max_words = (buffer_bits >> super::pack_bits_size) + 2;
+			std::array<std::pair<uint32, pack_type>, 2 * max_words> masks;
+			size_t mask_count = 0;
+			for (int64 pos : {int64{0}, pad_bits - buffer_bits}) {
+				for (int64 i = pos, ie = pos + buffer_bits; i < ie;) {
+					uint32 bit = static_cast<uint32>(i & super::pack_bits_mask);
+					int64 n = std::min<int64>(ie - i, static_cast<int64>(super::pack_bits - bit));
+					auto word = static_cast<uint32>(i >> super::pack_bits_size);
+					pack_type mask = util::make_mask<pack_type>(static_cast<size_t>(n), bit);
+					if (mask_count != 0 && masks[mask_count - 1].first == word)
+						masks[mask_count - 1].second |= mask;
+					else
+						masks[mask_count++] = {word, mask};
+					i += n;
 				}
-
-			for (int32 i = -static_cast<int32>(BufferSize), j = static_cast<int32>(mWidth); i < 0; i++, j++)
-				for (int32 y = 0, ye = static_cast<int32>(mHeight); y < ye; ++y) {
-					bit_set(i, y, value);
-					bit_set(j, y, value);
+			}
+			pack_type* row = row_data(0);
+			for (uint32 y = 0; y < mHeight; ++y, row += mRowWords) {
+				for (size_t i = 0; i < mask_count; ++i) {
+					auto [word, mask] = masks[i];
+					row[word] = (row[word] & ~mask) | (fill & mask);
 				}
+			}
+		}
+	}
+	/**
+	 * @brief Set only the buffer cells that lie within the region (x,y,width,height).
+	 *        Region may extend into the buffer, and is clipped to the padded table.
+	 */
+	void set_buffer_region(pack_type value, int32 x, int32 y, int32 width, int32 height) noexcept
+	{
+		if constexpr (BufferSize != 0) {
+			constexpr int32 bs = static_cast<int32>(BufferSize);
+			const int32 w = static_cast<int32>(mWidth), h = static_cast<int32>(mHeight);
+			int32 x1 = std::max(x, -bs), x2 = std::min(x + width, w + bs);
+			int32 y1 = std::max(y, -bs), y2 = std::min(y + height, h + bs);
+			if (x1 >= x2 || y1 >= y2)
+				return;
+			const pack_type fill = super::fill_word(value);
+			auto fill_cols = [fill](pack_type* row, int32 c1, int32 c2) noexcept {
+				if (c1 < c2)
+					details::bit_row_fill(row,
+					                      static_cast<int64>(c1 + bs) << super::bit_adj,
+					                      static_cast<int64>(c2 - c1) << super::bit_adj,
+					                      fill);
+			};
+			for (int32 i = y1; i < y2; ++i) {
+				pack_type* row = row_data(i);
+				if (i < 0 || i >= h) {
+					fill_cols(row, x1, x2);
+				} else {
+					fill_cols(row, x1, std::min(x2, 0));
+					fill_cols(row, std::max(x1, w), x2);
+				}
+			}
 		}
 	}
 
@@ -547,8 +1002,7 @@ public:
 		mWidth = 0;
 		mHeight = 0;
 		mRowWords = 0;
-		mCells.cells = nullptr;
-		mCells.cells_data = nullptr;
+		release_cells();
 	}
 
 	std::pair<uint32_t, uint32_t> bit_pair_index(int32 x, int32 y) const noexcept /// returns pair[word,bit]
@@ -588,6 +1042,13 @@ public:
 
 	const pack_type* data() const noexcept { return mCells.cells; }
 	pack_type* data() noexcept { return mCells.cells; }
+	/// first word of row y, starting at padded column -buffer_size
+	const pack_type* row_data(int32 y) const noexcept
+	{
+		assert(-static_cast<int32>(buffer_size) <= y && y < static_cast<int32>(mHeight + buffer_size));
+		return mCells.cells + static_cast<size_t>(y + static_cast<int32>(buffer_size)) * mRowWords;
+	}
+	pack_type* row_data(int32 y) noexcept { return const_cast<pack_type*>(std::as_const(*this).row_data(y)); }
 
 	/**
 	 * @brief Copy part to some region
@@ -611,6 +1072,78 @@ public:
 	void flip(int32 x, int32 y, int32 width, int32 height) { super::flip(data(), bit_adj_index(x, y), width, height); }
 	void flip(index_t id, int32 width, int32 height) { super::flip(data(), bit_adj_index(id), width, height); }
 
+	/// tight bounds of the set table cells, empty if none are set
+	bit_rect bounds() const noexcept { return bounds(0, 0, mWidth, mHeight); }
+	/// tight bounds of the set cells within region (x,y,width,height), which may extend into the buffer
+	bit_rect bounds(int32 x, int32 y, int32 width, int32 height) const noexcept
+	{
+		assert(width > 0 && height > 0);
+		assert(-static_cast<int32>(buffer_size) <= x && x + width <= static_cast<int32>(mWidth + buffer_size));
+		assert(-static_cast<int32>(buffer_size) <= y && y + height <= static_cast<int32>(mHeight + buffer_size));
+		return super::bounds(data(),
+		                     static_cast<int64>(bit_index(x, y).id),
+		                     static_cast<int64>(mRowWords) << super::pack_bits_size,
+		                     x,
+		                     y,
+		                     width,
+		                     height);
+	}
+	/**
+	 * @brief Construct a bit_cell of the bounds of the set table cells, nullptr if none are set.
+	 * @param rect if not null, set to the bounds of the cell within the table
+	 */
+	bit_cell<BitCount, PackType>* trim(std::pmr::memory_resource& res, bit_rect* rect = nullptr) const
+	{
+		bit_rect b = bounds();
+		if (rect != nullptr)
+			*rect = b;
+		if (b.empty())
+			return nullptr;
+		using cell_type = bit_cell<BitCount, PackType>;
+		constexpr auto max_length = static_cast<int64>(std::numeric_limits<typename cell_type::length_type>::max());
+		assert(b.width <= max_length && b.height <= max_length);
+		auto* cell = cell_type::construct(res,
+		                                  static_cast<typename cell_type::length_type>(b.width),
+		                                  static_cast<typename cell_type::length_type>(b.height));
+		const int64 bits = static_cast<int64>(b.width) << super::bit_adj;
+		for (int32 i = 0; i < b.height; ++i)
+			details::bit_row_copy(
+			  cell->data(), i * bits, data(), static_cast<int64>(bit_index(b.x, b.y + i).id), bits);
+		return cell;
+	}
+
+	/// bit expression operand of the cells shifted by (dx,dy), see bit_expr.hpp
+	auto shifted(int32 dx, int32 dy) const noexcept { return details::bit_expr_shift<bit_table>(*this, dx, dy); }
+
+	/**
+	 * @brief Shift the table cells by (dx,dy), cell (x,y) moves to (x+dx,y+dy).
+	 *        Uncovered cells are set to value, the buffer is unchanged.
+	 */
+	void shift(int32 dx, int32 dy, pack_type value = 0) noexcept { shift_into(*this, dx, dy, value); }
+	/**
+	 * @brief Write the table cells shifted by (dx,dy) into dest of the same dimensions.
+	 *        Uncovered cells of dest are set to value, the buffer of dest is unchanged.
+	 */
+	template <size_t DestBufferSize>
+	void shift_into(bit_table<BitCount, DestBufferSize, PackType>& dest,
+	                int32 dx,
+	                int32 dy,
+	                pack_type value = 0) const noexcept
+	{
+		assert(dest.getWidth() == mWidth && dest.getHeight() == mHeight);
+		super::shift(dest.row_data(0),
+		             static_cast<int64>(DestBufferSize) << super::bit_adj,
+		             static_cast<int64>(dest.getRowWords()) << super::pack_bits_size,
+		             row_data(0),
+		             static_cast<int64>(buffer_size) << super::bit_adj,
+		             static_cast<int64>(mRowWords) << super::pack_bits_size,
+		             mWidth,
+		             mHeight,
+		             dx,
+		             dy,
+		             value);
+	}
+
 	template <typename T>
 	void region_op(op OP, T& dest, int32 x, int32 y) const
 	{
@@ -649,10 +1182,85 @@ public:
 	}
 
 private:
+	/// ensure at least words are owned with the current row alignment, contents are undefined
+	void reserve_cells(size_t words)
+	{
+		const size_t align = std::max(cells_alignment, mRowAlign * sizeof(pack_type));
+		if (words <= mCells.capacity && align <= mCells.align)
+			return;
+		release_cells();
+		mCells.cells = static_cast<pack_type*>(mCells.res->allocate(words * sizeof(pack_type), align));
+		mCells.capacity = words;
+		mCells.align = align;
+	}
+	void release_cells() noexcept
+	{
+		if (mCells.capacity != 0)
+			mCells.res->deallocate(mCells.cells, mCells.capacity * sizeof(pack_type), mCells.align);
+		mCells.cells = nullptr;
+		mCells.capacity = 0;
+	}
+
 	uint32 mWidth, mHeight, mRowWords;
+	uint32 mRowAlign; ///< row alignment in words, power of 2
 	CellsData mCells;
 };
 
+/**
+ * @brief 32 byte header of a stream holding the native word buffer of a bit_table, written in native byte order.
+ *        Records the table layout and byte order, streams only load into a table of the same layout on a
+ *        machine of the same endianness.
+ *        generation numbers snapshots, a journal records the generation of the snapshot it patches.
+ */
+struct bit_table_header
+{
+	std::array<char, 4> magic;
+	uint8 version;
+	uint8 bit_count;
+	uint8 pack_bytes;
+	uint8 buffer_size;
+	uint8 little_endian;
+	uint8 reserved[3];
+	uint32 width;
+	uint32 height;
+	uint32 row_words;
+	uint64 generation;
+
+	/// word buffer snapshot of a table
+	static constexpr std::array<char, 4> snapshot_magic{'I', 'N', 'X', 'G'};
+	/// patch journal over a snapshot, see bit_journal.hpp
+	static constexpr std::array<char, 4> journal_magic{'I', 'N', 'X', 'J'};
+	static constexpr uint8 current_version = 1;
+
+	template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+	static bit_table_header make(const std::array<char, 4>& magic,
+	                             const bit_table<BitCount, BufferSize, PackType>& table,
+	                             uint64 generation = 0) noexcept
+	{
+		bit_table_header head{};
+		head.magic = magic;
+		head.version = current_version;
+		head.bit_count = static_cast<uint8>(BitCount);
+		head.pack_bytes = static_cast<uint8>(sizeof(PackType));
+		head.buffer_size = static_cast<uint8>(BufferSize);
+		head.little_endian = std::endian::native == std::endian::little;
+		head.width = table.getWidth();
+		head.height = table.getHeight();
+		head.row_words = table.getRowWords();
+		head.generation = generation;
+		return head;
+	}
+	/// true if written from a bit_table<BitCount, BufferSize, PackType> in native byte order
+	template <size_t BitCount, size_t BufferSize, std::unsigned_integral PackType>
+	bool same_layout() const noexcept
+	{
+		return bit_count == BitCount && pack_bytes == sizeof(PackType) && buffer_size == BufferSize &&
+		       little_endian == (std::endian::native == std::endian::little);
+	}
+	bool operator==(const bit_table_header&) const noexcept = default;
+};
+static_assert(sizeof(bit_table_header) == 32);
+
 template <size_t BitCount = 1, std::unsigned_integral PackType = size_t>
 class bit_cell : public details::bit_ops<BitCount, PackType>
 {
@@ -808,6 +1416,56 @@ public:
 	void flip(int32 x, int32 y, int32 width, int32 height) { super::flip(data(), bit_adj_index(x, y), width, height); }
 	void flip(index_t id, int32 width, int32 height) { super::flip(data(), bit_adj_index(id), width, height); }
 
+	/// tight bounds of the set cells, empty if none are set
+	bit_rect bounds() const noexcept { return bounds(0, 0, m_header.d.width, m_header.d.height); }
+	/// tight bounds of the set cells within region (x,y,width,height)
+	bit_rect bounds(int32 x, int32 y, int32 width, int32 height) const noexcept
+	{
+		assert(width > 0 && height > 0);
+		assert(0 <= x && x + width <= static_cast<int32>(m_header.d.width));
+		assert(0 <= y && y + height <= static_cast<int32>(m_header.d.height));
+		return super::bounds(data(),
+		                     static_cast<int64>(bit_index(x, y).id),
+		                     static_cast<int64>(m_header.d.width) << super::bit_adj,
+		                     x,
+		                     y,
+		                     width,
+		                     height);
+	}
+	/**
+	 * @brief Construct a bit_cell of the bounds of the set cells, nullptr if none are set.
+	 * @param rect if not null, set to the bounds of the new cell within this cell
+	 */
+	bit_cell* trim(std::pmr::memory_resource& res, bit_rect* rect = nullptr) const
+	{
+		bit_rect b = bounds();
+		if (rect != nullptr)
+			*rect = b;
+		if (b.empty())
+			return nullptr;
+		auto* cell = construct(res, static_cast<length_type>(b.width), static_cast<length_type>(b.height));
+		const int64 bits = static_cast<int64>(b.width) << super::bit_adj;
+		for (int32 i = 0; i < b.height; ++i)
+			details::bit_row_copy(
+			  cell->data(), i * bits, data(), static_cast<int64>(bit_index(b.x, b.y + i).id), bits);
+		return cell;
+	}
+
+	/**
+	 * @brief Shift the cells by (dx,dy), cell (x,y) moves to (x+dx,y+dy), uncovered cells are set to value
+	 */
+	void shift(int32 dx, int32 dy, pack_type value = 0) noexcept { shift_into(*this, dx, dy, value); }
+	/**
+	 * @brief Write the cells shifted by (dx,dy) into dest of the same dimensions, uncovered cells are set to value
+	 */
+	void shift_into(bit_cell& dest, int32 dx, int32 dy, pack_type value = 0) const noexcept
+	{
+		assert(m_header.word == dest.m_header.word);
+		const int64 row_bits = static_cast<int64>(m_header.d.width) << super::bit_adj;
+		super::shift(
+		  dest.data(), 0, row_bits, data(), 0, row_bits, m_header.d.width, m_header.d.height, dx, dy, value);
+	}
+
 	template <typename T>
 	void region_op(op OP, T& dest, int32 x, int32 y)
 	{
@@ -0,0 +1,535 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_BIT_VOLUME_HPP
+#define INXLIB_DATA_BIT_VOLUME_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <memory_resource>
+#include <utility>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+namespace details {
+/**
+ * @brief Apply dst = dst OP src over rows of bits, a word at a time.
+ *        Rows start at dpos/spos with rows drow_bits/srow_bits apart, lanes are masked by lane_mask.
+ */
+template <typename Op, std::unsigned_integral PackType>
+void
+bit_rows_op(PackType* dst,
+            int64 dpos,
+            int64 drow_bits,
+            const PackType* src,
+            int64 spos,
+            int64 srow_bits,
+            int64 bits,
+            int64 rows,
+            PackType lane_mask,
+            Op&& op) noexcept
+{
+	constexpr int64 pack_bits = sizeof(PackType) * CHAR_BIT;
+	for (int64 r = 0; r < rows; ++r, dpos += drow_bits, spos += srow_bits) {
+		for (int64 i = 0; i < bits; i += pack_bits) {
+			const int64 n = std::min(pack_bits, bits - i);
+			const PackType v = bit_row_read(src, spos + i, spos + bits);
+			const PackType cur = bit_row_read(static_cast<const PackType*>(dst), dpos + i, dpos + bits);
+			bit_row_write<PackType>(dst,
+			                        dpos + i,
+			                        static_cast<PackType>(op(cur, v)),
+			                        util::make_mask<PackType>(static_cast<size_t>(n)) & lane_mask);
+		}
+	}
+}
+} // namespace details
+
+/**
+ * @brief A 3d grid of cells, stored as a stack of z-planes that each share the bit_table layout.
+ *
+ * Rows are padded as with bit_table, planes are (height + 2*BufferSize) rows apart, with
+ * BufferSize buffer planes before and after. A plane can be viewed as a bit_table, and
+ * region<W,H,D> stacks the region<W,H> of D consecutive planes into a single code.
+ */
+template <size_t BitCount = 1, size_t BufferSize = 0, std::unsigned_integral PackType = size_t>
+class bit_volume : public details::bit_ops<BitCount, PackType>
+{
+public:
+	using super = details::bit_ops<BitCount, PackType>;
+	using typename super::adj_index;
+	using typename super::index_t;
+	using typename super::op;
+	using typename super::pack_type;
+	using table_type = bit_table<BitCount, BufferSize, PackType>;
+	static constexpr size_t buffer_size = BufferSize;
+	using size_type = size_t;
+	static constexpr size_t cells_alignment = table_type::cells_alignment;
+
+	bit_volume() noexcept
+	  : bit_volume(nullptr)
+	{
+	}
+	explicit bit_volume(std::pmr::memory_resource* res) noexcept
+	  : mWidth(0)
+	  , mHeight(0)
+	  , mDepth(0)
+	  , mRowWords(0)
+	  , mCells(nullptr)
+	  , mCapacity(0)
+	  , mRes(res != nullptr ? res : std::pmr::get_default_resource())
+	{
+	}
+	bit_volume(uint32 width, uint32 height, uint32 depth, std::pmr::memory_resource* res = nullptr)
+	  : bit_volume(res)
+	{
+		setup(width, height, depth);
+	}
+	bit_volume(bit_volume&& other) noexcept
+	  : mWidth(std::exchange(other.mWidth, 0))
+	  , mHeight(std::exchange(other.mHeight, 0))
+	  , mDepth(std::exchange(other.mDepth, 0))
+	  , mRowWords(std::exchange(other.mRowWords, 0))
+	  , mCells(std::exchange(other.mCells, nullptr))
+	  , mCapacity(std::exchange(other.mCapacity, 0))
+	  , mRes(other.mRes)
+	{
+	}
+	bit_volume(const bit_volume& other)
+	  : bit_volume(nullptr)
+	{
+		*this = other;
+	}
+	~bit_volume() { release_cells(); }
+
+	bit_volume& operator=(bit_volume&& other)
+	{
+		if (this != &other) {
+			if (mRes == other.mRes || *mRes == *other.mRes) {
+				release_cells();
+				mWidth = std::exchange(other.mWidth, 0);
+				mHeight = std::exchange(other.mHeight, 0);
+				mDepth = std::exchange(other.mDepth, 0);
+				mRowWords = std::exchange(other.mRowWords, 0);
+				mCells = std::exchange(other.mCells, nullptr);
+				mCapacity = std::exchange(other.mCapacity, 0);
+			} else {
+				*this = std::as_const(other);
+			}
+		}
+		return *this;
+	}
+	/// reuses the allocated cells if large enough
+	bit_volume& operator=(const bit_volume& other)
+	{
+		if (this != &other) {
+			if (other.mCells == nullptr) {
+				clear();
+				return *this;
+			}
+			mWidth = other.mWidth;
+			mHeight = other.mHeight;
+			mDepth = other.mDepth;
+			mRowWords = other.mRowWords;
+			reserve_cells(calc_cells_words());
+			std::memcpy(mCells, other.mCells, calc_cells_words() * sizeof(pack_type));
+		}
+		return *this;
+	}
+
+	std::pmr::memory_resource* get_resource() const noexcept { return mRes; }
+
+	void setup(uint32 width, uint32 height, uint32 depth)
+	{
+		assert(width > 0 && height > 0 && depth > 0);
+		mWidth = width;
+		mHeight = height;
+		mDepth = depth;
+		mRowWords = static_cast<uint32>(((width + 2 * buffer_size + super::item_count - 1) >> super::pack_size) + 1);
+		reserve_cells(calc_cells_words());
+		std::memset(mCells, 0, calc_cells_words() * sizeof(pack_type));
+	}
+	void clear()
+	{
+		mWidth = mHeight = mDepth = mRowWords = 0;
+		release_cells();
+	}
+
+	uint32 getWidth() const noexcept { return mWidth; }
+	uint32 getHeight() const noexcept { return mHeight; }
+	uint32 getDepth() const noexcept { return mDepth; }
+	uint32 getPadWidth() const noexcept { return mWidth + 2 * buffer_size; }
+	uint32 getPadHeight() const noexcept { return mHeight + 2 * buffer_size; }
+	uint32 getPadDepth() const noexcept { return mDepth + 2 * buffer_size; }
+	uint32 getRowWords() const noexcept { return mRowWords; }
+	size_t getPlaneWords() const noexcept { return static_cast<size_t>(getPadHeight()) * mRowWords; }
+	size_t calc_cells_words() const noexcept { return getPadDepth() * getPlaneWords(); }
+	bool empty() const noexcept { return mWidth == 0; }
+
+	const pack_type* data() const noexcept { return mCells; }
+	pack_type* data() noexcept { return mCells; }
+	/// first word of plane z, starting at padded row -buffer_size
+	const pack_type* plane_data(int32 z) const noexcept
+	{
+		assert(-static_cast<int32>(buffer_size) <= z && z < static_cast<int32>(mDepth + buffer_size));
+		return mCells + static_cast<size_t>(z + static_cast<int32>(buffer_size)) * getPlaneWords();
+	}
+	pack_type* plane_data(int32 z) noexcept { return const_cast<pack_type*>(std::as_const(*this).plane_data(z)); }
+	/// first word of row y of plane z, starting at padded column -buffer_size
+	const pack_type* row_data(int32 y, int32 z) const noexcept
+	{
+		assert(-static_cast<int32>(buffer_size) <= y && y < static_cast<int32>(mHeight + buffer_size));
+		return plane_data(z) + static_cast<size_t>(y + static_cast<int32>(buffer_size)) * mRowWords;
+	}
+	pack_type* row_data(int32 y, int32 z) noexcept
+	{
+		return const_cast<pack_type*>(std::as_const(*this).row_data(y, z));
+	}
+
+	/**
+	 * @brief A bit_table viewing plane z, including its buffer.
+	 *        The view does not own its cells and is invalidated by setup/clear.
+	 */
+	table_type plane(int32 z) noexcept
+	{
+		table_type view;
+		view.setup(mWidth, mHeight, plane_data(z));
+		assert(view.getRowWords() == mRowWords);
+		return view;
+	}
+
+	index_t bit_index(int32 x, int32 y, int32 z) const noexcept
+	{
+		assert(-static_cast<int32>(buffer_size) <= x && x < static_cast<int32>(mWidth + buffer_size));
+		return index_t(static_cast<uint64>(row_data(y, z) - mCells) * super::pack_bits +
+		               (static_cast<uint64>(x + static_cast<int32>(buffer_size)) << super::bit_adj));
+	}
+	adj_index bit_adj_index(index_t id) const noexcept { return adj_index(id, mRowWords << super::pack_bits_size); }
+	adj_index bit_adj_index(int32 x, int32 y, int32 z) const noexcept { return bit_adj_index(bit_index(x, y, z)); }
+
+	pack_type bit_get(int32 x, int32 y, int32 z) const noexcept { return bit_get(bit_index(x, y, z)); }
+	template <size_t I = 0>
+	bool bit_test(int32 x, int32 y, int32 z) const noexcept
+	{
+		return bit_test<I>(bit_index(x, y, z));
+	}
+	void bit_set(int32 x, int32 y, int32 z, pack_type value) noexcept { bit_set(bit_index(x, y, z), value); }
+	void bit_clear(int32 x, int32 y, int32 z) noexcept { bit_clear(bit_index(x, y, z)); }
+	void bit_and(int32 x, int32 y, int32 z, pack_type value) noexcept { bit_and(bit_index(x, y, z), value); }
+	void bit_or(int32 x, int32 y, int32 z, pack_type value) noexcept { bit_or(bit_index(x, y, z), value); }
+	void bit_xor(int32 x, int32 y, int32 z, pack_type value) noexcept { bit_xor(bit_index(x, y, z), value); }
+	void bit_nand(int32 x, int32 y, int32 z, pack_type value) noexcept { bit_nand(bit_index(x, y, z), value); }
+
+	pack_type bit_get(index_t id) const noexcept { return super::bit_get(mCells, id); }
+	template <size_t I = 0>
+	bool bit_test(index_t id) const noexcept
+	{
+		return super::template bit_test<I>(mCells, id);
+	}
+	void bit_set(index_t id, pack_type value) noexcept { super::bit_set(mCells, id, value); }
+	void bit_clear(index_t id) noexcept { super::bit_clear(mCells, id); }
+	void bit_or(index_t id, pack_type value) noexcept { super::bit_or(mCells, id, value); }
+	void bit_and(index_t id, pack_type value) noexcept { super::bit_and(mCells, id, value); }
+	void bit_xor(index_t id, pack_type value) noexcept { super::bit_xor(mCells, id, value); }
+	void bit_nand(index_t id, pack_type value) noexcept { super::bit_nand(mCells, id, value); }
+	void bit_not(index_t id) noexcept { super::bit_not(mCells, id); }
+
+	/// set every buffer cell to value, including the buffer planes
+	void set_buffer(pack_type value) noexcept
+	{
+		if constexpr (BufferSize != 0) {
+			const pack_type fill = super::fill_word(value);
+			const int64 plane_bits = static_cast<int64>(getPlaneWords()) << super::pack_bits_size;
+			for (int32 i = -static_cast<int32>(BufferSize), j = static_cast<int32>(mDepth); i < 0; i++, j++) {
+				details::bit_row_fill(plane_data(i), 0, plane_bits, fill);
+				details::bit_row_fill(plane_data(j), 0, plane_bits, fill);
+			}
+			for (int32 z = 0; z < static_cast<int32>(mDepth); ++z)
+				plane(z).set_buffer(value);
+		}
+	}
+
+	/**
+	 * @brief Code of the W*H*D cells at id, plane i of the region at bits [i*W*H*bit_count, (i+1)*W*H*bit_count).
+	 */
+	template <int32 W, int32 H, int32 D>
+	pack_type region(index_t id) const noexcept
+	{
+		static_assert(D > 0, "region must be positive");
+		static_assert(static_cast<int64>(W) * H * D <= static_cast<int64>(1 << super::pack_size),
+		              "must be packable in a single pack_type");
+		constexpr size_t plane_shift = static_cast<size_t>(W * H) * super::bit_count;
+		const uint64 plane_bits = static_cast<uint64>(getPlaneWords()) << super::pack_bits_size;
+		pack_type ans = super::template region<W, H>(mCells, mRowWords, id);
+		for (int32 i = 1; i < D; ++i) {
+			id.id += plane_bits;
+			ans |= static_cast<pack_type>(super::template region<W, H>(mCells, mRowWords, id) << (i * plane_shift));
+		}
+		return ans;
+	}
+	/// region<W,H,D> with (x,y,z) at (X,Y,Z) of the region
+	template <int32 X, int32 Y, int32 Z, int32 W, int32 H, int32 D>
+	pack_type region(int32 x, int32 y, int32 z) const noexcept
+	{
+		static_assert(X >= 0 && W > 0 && X < W, "x must lie within region");
+		static_assert(Y >= 0 && H > 0 && Y < H, "y must lie within region");
+		static_assert(Z >= 0 && D > 0 && Z < D, "z must lie within region");
+		assert(-static_cast<int32>(buffer_size) <= x - X && x - X + W <= static_cast<int32>(mWidth + buffer_size));
+		assert(-static_cast<int32>(buffer_size) <= y - Y && y - Y + H <= static_cast<int32>(mHeight + buffer_size));
+		assert(-static_cast<int32>(buffer_size) <= z - Z && z - Z + D <= static_cast<int32>(mDepth + buffer_size));
+		return region<W, H, D>(bit_index(x - X, y - Y, z - Z));
+	}
+
+	/**
+	 * @brief Copy the width*height*depth cells at (o_x,o_y,o_z) to dest at (x,y,z), a word of a row at a time.
+	 */
+	template <size_t DestBuffer>
+	void copy(int32 o_x,
+	          int32 o_y,
+	          int32 o_z,
+	          int32 width,
+	          int32 height,
+	          int32 depth,
+	          bit_volume<BitCount, DestBuffer, PackType>& dest,
+	          int32 x,
+	          int32 y,
+	          int32 z) const noexcept
+	{
+		assert(width > 0 && height > 0 && depth > 0);
+		for (int32 k = 0; k < depth; ++k) {
+			for (int32 j = 0; j < height; ++j) {
+				details::bit_row_copy(dest.data(),
+				                      static_cast<int64>(dest.bit_index(x, y + j, z + k).id),
+				                      mCells,
+				                      static_cast<int64>(bit_index(o_x, o_y + j, o_z + k).id),
+				                      static_cast<int64>(width) << super::bit_adj);
+			}
+		}
+	}
+	/**
+	 * @brief Apply dest = dest OP cells for the width*height*depth cells at (o_x,o_y,o_z) to dest at (x,y,z).
+	 */
+	template <size_t DestBuffer>
+	void region_op(op OP,
+	               int32 o_x,
+	               int32 o_y,
+	               int32 o_z,
+	               int32 width,
+	               int32 height,
+	               int32 depth,
+	               bit_volume<BitCount, DestBuffer, PackType>& dest,
+	               int32 x,
+	               int32 y,
+	               int32 z) const noexcept
+	{
+		assert(width > 0 && height > 0 && depth > 0);
+		for (int32 k = 0; k < depth; ++k) {
+			apply_op(OP,
+			         dest.data(),
+			         static_cast<int64>(dest.bit_index(x, y, z + k).id),
+			         static_cast<int64>(dest.getRowWords()) << super::pack_bits_size,
+			         mCells,
+			         static_cast<int64>(bit_index(o_x, o_y, o_z + k).id),
+			         static_cast<int64>(mRowWords) << super::pack_bits_size,
+			         static_cast<int64>(width) << super::bit_adj,
+			         height);
+		}
+	}
+
+	/// copy the cells of plane z to a table of the same width and height, its buffer is unchanged
+	template <size_t TableBuffer>
+	void copy_slice(int32 z, bit_table<BitCount, TableBuffer, PackType>& dest) const noexcept
+	{
+		assert(dest.getWidth() == mWidth && dest.getHeight() == mHeight);
+		for (int32 j = 0; j < static_cast<int32>(mHeight); ++j)
+			details::bit_row_copy(dest.row_data(j),
+			                      static_cast<int64>(TableBuffer) << super::bit_adj,
+			                      row_data(j, z),
+			                      static_cast<int64>(buffer_size) << super::bit_adj,
+			                      static_cast<int64>(mWidth) << super::bit_adj);
+	}
+	/// copy the cells of a table of the same width and height to plane z
+	template <size_t TableBuffer>
+	void copy_slice_from(const bit_table<BitCount, TableBuffer, PackType>& src, int32 z) noexcept
+	{
+		assert(src.getWidth() == mWidth && src.getHeight() == mHeight);
+		for (int32 j = 0; j < static_cast<int32>(mHeight); ++j)
+			details::bit_row_copy(row_data(j, z),
+			                      static_cast<int64>(buffer_size) << super::bit_adj,
+			                      src.row_data(j),
+			                      static_cast<int64>(TableBuffer) << super::bit_adj,
+			                      static_cast<int64>(mWidth) << super::bit_adj);
+	}
+	/// apply dest = dest OP plane z, for a table of the same width and height
+	template <size_t TableBuffer>
+	void region_op_slice(op OP, int32 z, bit_table<BitCount, TableBuffer, PackType>& dest) const noexcept
+	{
+		assert(dest.getWidth() == mWidth && dest.getHeight() == mHeight);
+		apply_op(OP,
+		         dest.row_data(0),
+		         static_cast<int64>(TableBuffer) << super::bit_adj,
+		         static_cast<int64>(dest.getRowWords()) << super::pack_bits_size,
+		         row_data(0, z),
+		         static_cast<int64>(buffer_size) << super::bit_adj,
+		         static_cast<int64>(mRowWords) << super::pack_bits_size,
+		         static_cast<int64>(mWidth) << super::bit_adj,
+		         mHeight);
+	}
+	/// apply plane z = plane z OP src, for a table of the same width and height
+	template <size_t TableBuffer>
+	void region_op_slice_from(op OP, const bit_table<BitCount, TableBuffer, PackType>& src, int32 z) noexcept
+	{
+		assert(src.getWidth() == mWidth && src.getHeight() == mHeight);
+		apply_op(OP,
+		         row_data(0, z),
+		         static_cast<int64>(buffer_size) << super::bit_adj,
+		         static_cast<int64>(mRowWords) << super::pack_bits_size,
+		         src.row_data(0),
+		         static_cast<int64>(TableBuffer) << super::bit_adj,
+		         static_cast<int64>(src.getRowWords()) << super::pack_bits_size,
+		         static_cast<int64>(mWidth) << super::bit_adj,
+		         mHeight);
+	}
+
+	/// number of non-zero cells in the planes [z1, z2)
+	uint64 popcount(int32 z1, int32 z2) const noexcept
+	{
+		uint64 count = 0;
+		for (int32 z = z1; z < z2; ++z)
+			for_each_word(z, [&count](int32, int32, pack_type w) { count += static_cast<uint64>(util::popcount(w)); });
+		return count;
+	}
+	/// number of non-zero cells in plane z
+	uint64 popcount(int32 z) const noexcept { return popcount(z, z + 1); }
+	/// true if plane z has a non-zero cell
+	bool any(int32 z) const noexcept
+	{
+		for (int32 j = 0; j < static_cast<int32>(mHeight); ++j)
+			for (int32 i = 0; i < static_cast<int32>(mWidth); i += static_cast<int32>(super::item_count))
+				if (lane_word(j, z, i) != 0)
+					return true;
+		return false;
+	}
+	/// tight bounds of the non-zero cells of plane z, empty if none
+	bit_rect bounds(int32 z) const noexcept
+	{
+		return super::bounds(mCells,
+		                     static_cast<int64>(bit_index(0, 0, z).id),
+		                     static_cast<int64>(mRowWords) << super::pack_bits_size,
+		                     0,
+		                     0,
+		                     static_cast<int32>(mWidth),
+		                     static_cast<int32>(mHeight));
+	}
+	/// call fn(x, y) for every non-zero cell of plane z in row order, skipping zero words
+	template <typename Fn>
+	void scan(int32 z, Fn&& fn) const
+	{
+		for_each_word(z, [&fn](int32 x, int32 y, pack_type w) {
+			for (; w != 0; w &= w - 1)
+				fn(x + static_cast<int32>(static_cast<uint32>(util::ctz(w)) >> super::bit_adj), y);
+		});
+	}
+
+protected:
+	/// item_count cells of row y of plane z from column x, each folded to the lowest bit of its lane
+	pack_type lane_word(int32 y, int32 z, int32 x) const noexcept
+	{
+		const int64 pos = static_cast<int64>(buffer_size + x) << super::bit_adj;
+		pack_type w = details::bit_row_read(
+		  row_data(y, z), pos, static_cast<int64>(buffer_size + mWidth) << super::bit_adj);
+		if constexpr (super::bit_adj != 0) {
+			for (size_t s = 1; s < (size_t{1} << super::bit_adj); s <<= 1)
+				w |= static_cast<pack_type>(w >> s);
+			w &= super::fill_word(1);
+		}
+		return w;
+	}
+	template <typename Fn>
+	void for_each_word(int32 z, Fn&& fn) const
+	{
+		for (int32 j = 0; j < static_cast<int32>(mHeight); ++j)
+			for (int32 i = 0; i < static_cast<int32>(mWidth); i += static_cast<int32>(super::item_count))
+				if (pack_type w = lane_word(j, z, i); w != 0)
+					fn(i, j, w);
+	}
+
+	static void apply_op(op OP,
+	                     pack_type* dst,
+	                     int64 dpos,
+	                     int64 drow_bits,
+	                     const pack_type* src,
+	                     int64 spos,
+	                     int64 srow_bits,
+	                     int64 bits,
+	                     int64 rows) noexcept
+	{
+		const pack_type lanes = super::fill_word(super::bit_mask);
+		auto run = [&](auto fn) {
+			details::bit_rows_op(dst, dpos, drow_bits, src, spos, srow_bits, bits, rows, lanes, fn);
+		};
+		switch (OP) {
+		case op::OR:
+			run([](pack_type a, pack_type b) { return a | b; });
+			break;
+		case op::AND:
+			run([](pack_type a, pack_type b) { return a & b; });
+			break;
+		case op::XOR:
+			run([](pack_type a, pack_type b) { return a ^ b; });
+			break;
+		case op::NAND:
+			run([](pack_type a, pack_type b) { return ~(a & b); });
+			break;
+		}
+	}
+
+	void reserve_cells(size_t words)
+	{
+		if (words <= mCapacity)
+			return;
+		release_cells();
+		mCells = static_cast<pack_type*>(mRes->allocate(words * sizeof(pack_type), cells_alignment));
+		mCapacity = words;
+	}
+	void release_cells() noexcept
+	{
+		if (mCapacity != 0)
+			mRes->deallocate(mCells, mCapacity * sizeof(pack_type), cells_alignment);
+		mCells = nullptr;
+		mCapacity = 0;
+	}
+
+	uint32 mWidth, mHeight, mDepth, mRowWords;
+	pack_type* mCells;
+	size_t mCapacity;
+	std::pmr::memory_resource* mRes;
+};
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_BIT_VOLUME_HPP
@@ -0,0 +1,260 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_FIXED_BIT_CELL_HPP
+#define INXLIB_DATA_FIXED_BIT_CELL_HPP
+
+#include <array>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <utility>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+/**
+ * @brief A bit_cell with compile-time dimensions and inline storage.
+ *
+ * Cells share the bit_cell layout, packed row after row with no row padding, so conversion
+ * to and from bit_cell is a word copy. Row operations against bit_table/bit_cell are unrolled
+ * over the compile-time rows, moving up to a word of cells at a time.
+ */
+template <size_t Width, size_t Height, size_t BitCount = 1, std::unsigned_integral PackType = size_t>
+class fixed_bit_cell : public details::bit_ops<BitCount, PackType>
+{
+public:
+	using super = details::bit_ops<BitCount, PackType>;
+	using typename super::adj_index;
+	using typename super::index_t;
+	using typename super::op;
+	using typename super::pack_type;
+	using size_type = size_t;
+	static_assert(Width > 0 && Height > 0, "dimensions must be positive");
+
+	static constexpr size_t width = Width;
+	static constexpr size_t height = Height;
+	static constexpr size_t row_bits = Width << super::bit_adj;
+	static constexpr size_t cell_bits = row_bits * Height;
+	static constexpr size_t words = (cell_bits + super::pack_bits - 1) >> super::pack_bits_size;
+	/// words of a row chunked for row operations
+	static constexpr size_t row_chunks = (row_bits + super::pack_bits - 1) >> super::pack_bits_size;
+
+	constexpr fixed_bit_cell() noexcept
+	  : m_cells{}
+	{
+	}
+	/// every cell set to value
+	constexpr explicit fixed_bit_cell(pack_type value) noexcept
+	  : m_cells{}
+	{
+		fill(value);
+	}
+	explicit fixed_bit_cell(const bit_cell<BitCount, PackType>& cell) noexcept
+	  : m_cells{}
+	{
+		from_cell(cell);
+	}
+
+	constexpr void fill(pack_type value) noexcept
+	{
+		m_cells.fill(super::fill_word(value));
+		if constexpr (cell_bits % super::pack_bits != 0)
+			m_cells.back() &= util::make_mask<pack_type>(cell_bits % super::pack_bits);
+	}
+
+	/// copy from a bit_cell of the same dimensions
+	void from_cell(const bit_cell<BitCount, PackType>& cell) noexcept
+	{
+		assert(cell.getWidth() == Width && cell.getHeight() == Height);
+		std::copy_n(cell.data(), words, m_cells.data());
+	}
+	/// copy to a bit_cell of the same dimensions
+	void to_cell(bit_cell<BitCount, PackType>& cell) const noexcept
+	{
+		assert(cell.getWidth() == Width && cell.getHeight() == Height);
+		std::copy_n(m_cells.data(), words, cell.data());
+	}
+	bit_cell<BitCount, PackType>* construct_cell(std::pmr::memory_resource& res) const
+	{
+		auto* cell = bit_cell<BitCount, PackType>::construct(res, Width, Height);
+		to_cell(*cell);
+		return cell;
+	}
+
+	/**
+	 * @brief Copy to some bit table at (x,y)
+	 */
+	template <typename T>
+	void copy(T& dest, int32 x, int32 y) const noexcept
+	{
+		for_rows([&](size_t row, size_t pos, pack_type value, size_t n) {
+			details::bit_row_write<pack_type>(
+			  dest.data(), dest_pos(dest, x, y, row) + pos, value, util::make_mask<pack_type>(n));
+		});
+	}
+	/**
+	 * @brief Copy from some bit table at (x,y)
+	 */
+	template <typename T>
+	void copy_from(const T& src, int32 x, int32 y) noexcept
+	{
+		for_rows([&](size_t row, size_t pos, pack_type, size_t n) {
+			const int64 at = dest_pos(src, x, y, row) + pos;
+			details::bit_row_write<pack_type>(m_cells.data(),
+			                                  static_cast<int64>(row * row_bits + pos),
+			                                  details::bit_row_read(src.data(), at, at + static_cast<int64>(n)),
+			                                  util::make_mask<pack_type>(n));
+		});
+	}
+
+	/**
+	 * @brief Apply dest = dest OP cells to some bit table at (x,y)
+	 */
+	template <typename T>
+	void region_op(op OP, T& dest, int32 x, int32 y) const noexcept
+	{
+		for_rows([&](size_t row, size_t pos, pack_type value, size_t n) {
+			const int64 at = dest_pos(dest, x, y, row) + pos;
+			pack_type cur = details::bit_row_read(dest.data(), at, at + static_cast<int64>(n));
+			switch (OP) {
+			case op::OR:
+				cur |= value;
+				break;
+			case op::AND:
+				cur &= value;
+				break;
+			case op::XOR:
+				cur ^= value;
+				break;
+			case op::NAND:
+				cur = static_cast<pack_type>(~(cur & value));
+				break;
+			}
+			details::bit_row_write<pack_type>(
+			  dest.data(), at, cur, util::make_mask<pack_type>(n) & super::fill_word(super::bit_mask));
+		});
+	}
+
+	pack_type bit_get(int32 x, int32 y) const noexcept { return bit_get(bit_index(x, y)); }
+	template <size_t I = 0>
+	bool bit_test(int32 x, int32 y) const noexcept
+	{
+		return bit_test<I>(bit_index(x, y));
+	}
+	void bit_set(int32 x, int32 y, pack_type value) noexcept { return bit_set(bit_index(x, y), value); }
+	void bit_clear(int32 x, int32 y) noexcept { return bit_clear(bit_index(x, y)); }
+	void bit_and(int32 x, int32 y, pack_type value) noexcept { return bit_and(bit_index(x, y), value); }
+	void bit_or(int32 x, int32 y, pack_type value) noexcept { return bit_or(bit_index(x, y), value); }
+	void bit_xor(int32 x, int32 y, pack_type value) noexcept { return bit_xor(bit_index(x, y), value); }
+	void bit_nand(int32 x, int32 y, pack_type value) noexcept { return bit_nand(bit_index(x, y), value); }
+
+	static constexpr size_t getWidth() noexcept { return Width; }
+	static constexpr size_t getHeight() noexcept { return Height; }
+
+	static constexpr index_t bit_index(int32 x, int32 y) noexcept
+	{
+		assert(static_cast<size_t>(x) < Width);
+		assert(static_cast<size_t>(y) < Height);
+		return index_t((static_cast<uint64>(y) * Width + static_cast<uint64>(x)) << super::bit_adj);
+	}
+	static constexpr adj_index bit_adj_index(index_t id) noexcept { return adj_index(id, row_bits); }
+	static constexpr adj_index bit_adj_index(int32 x, int32 y) noexcept { return bit_adj_index(bit_index(x, y)); }
+	pack_type bit_get(index_t id) const noexcept { return super::bit_get(data(), id); }
+	template <size_t I = 0>
+	bool bit_test(index_t id) const noexcept
+	{
+		return super::template bit_test<I>(data(), id);
+	}
+	void bit_set(index_t id, pack_type value) noexcept { super::bit_set(data(), id, value); }
+	void bit_clear(index_t id) noexcept { super::bit_clear(data(), id); }
+	void bit_or(index_t id, pack_type value) noexcept { super::bit_or(data(), id, value); }
+	void bit_and(index_t id, pack_type value) noexcept { super::bit_and(data(), id, value); }
+	void bit_xor(index_t id, pack_type value) noexcept { super::bit_xor(data(), id, value); }
+	void bit_nand(index_t id, pack_type value) noexcept { super::bit_nand(data(), id, value); }
+	void bit_not(index_t id) noexcept { super::bit_not(data(), id); }
+
+	pack_type word_get(index_t id) const noexcept { return super::word_get(data(), id); }
+	void word_set(index_t id, pack_type value) noexcept { super::word_set(data(), id, value); }
+
+	constexpr const pack_type* data() const noexcept { return m_cells.data(); }
+	constexpr pack_type* data() noexcept { return m_cells.data(); }
+	constexpr const std::array<pack_type, words>& cells() const noexcept { return m_cells; }
+
+	constexpr bool operator==(const fixed_bit_cell& o) const noexcept { return m_cells == o.m_cells; }
+
+	bool operator==(const bit_cell<BitCount, PackType>& o) const noexcept
+	{
+		return o.getWidth() == Width && o.getHeight() == Height && std::equal(m_cells.begin(), m_cells.end(), o.data());
+	}
+
+private:
+	template <typename T>
+	static int64 dest_pos(const T& dest, int32 x, int32 y, size_t row) noexcept
+	{
+		return static_cast<int64>(dest.bit_index(x, y + static_cast<int32>(row)).id);
+	}
+	/// call fn(row, pos, value, bits) for each word-sized chunk of every row, unrolled
+	template <typename Fn>
+	void for_rows(Fn&& fn) const noexcept
+	{
+		[&]<size_t... R>(std::index_sequence<R...>) {
+			(for_row<R>(fn, std::make_index_sequence<row_chunks>()), ...);
+		}(std::make_index_sequence<Height>());
+	}
+	template <size_t R, typename Fn, size_t... C>
+	void for_row(Fn& fn, std::index_sequence<C...>) const noexcept
+	{
+		constexpr int64 limit = static_cast<int64>((R + 1) * row_bits);
+		(fn(R,
+		    C * super::pack_bits,
+		    details::bit_row_read(m_cells.data(), static_cast<int64>(R * row_bits + C * super::pack_bits), limit),
+		    std::min(super::pack_bits, row_bits - C * super::pack_bits)),
+		 ...);
+	}
+
+	std::array<pack_type, words> m_cells;
+};
+
+} // namespace inx::data
+
+namespace std {
+
+template <size_t Width, size_t Height, size_t BitCount, typename PackType>
+struct hash<inx::data::fixed_bit_cell<Width, Height, BitCount, PackType>>
+{
+	size_t operator()(const inx::data::fixed_bit_cell<Width, Height, BitCount, PackType>& val) const noexcept
+	{
+		std::hash<size_t> hasher;
+		size_t seed = hasher((Width << 32) | Height);
+		[&]<size_t... I>(std::index_sequence<I...>) {
+			((seed ^= hasher(static_cast<size_t>(val.cells()[I])) + 0x9e3779b9 + (seed << 6) + (seed >> 2)), ...);
+		}(std::make_index_sequence<inx::data::fixed_bit_cell<Width, Height, BitCount, PackType>::words>());
+		return seed;
+	}
+};
+
+} // namespace std
+
+#endif // INXLIB_DATA_FIXED_BIT_CELL_HPP
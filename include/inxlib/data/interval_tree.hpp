@@ -0,0 +1,193 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_INTERVAL_TREE_HPP
+#define INXLIB_DATA_INTERVAL_TREE_HPP
+
+#include <inxlib/inx.hpp>
+#include <limits>
+
+#include "redblack_tree.hpp"
+
+namespace inx::data {
+
+template <typename Node, typename Tag = void>
+class interval_tree;
+template <typename T, typename Tag = void>
+struct interval_tree_tag;
+
+/**
+ * @brief A redblack tree node holding the half-open interval [low, high).
+ *
+ * The interval must not change while the node is in an interval_tree, erase and re-insert instead.
+ */
+template <typename T, typename Tag>
+struct interval_tree_tag : redblack_tree_aggregate_tag<T, Tag>
+{
+	using self = interval_tree_tag<T, Tag>;
+	using super = redblack_tree_aggregate_tag<T, Tag>;
+	using interval_node = self;
+	using interval_type = T;
+
+	void set_interval(T low, T high) noexcept
+	{
+		assert(!(high < low));
+		m_intervalData.low = low;
+		m_intervalData.high = high;
+	}
+	const T& interval_low() const noexcept { return m_intervalData.low; }
+	const T& interval_high() const noexcept { return m_intervalData.high; }
+	/// max interval_high() over the subtree
+	const T& subtree_high() const noexcept { return this->subtree_aggregate(); }
+
+	struct IntervalData
+	{
+		T low;
+		T high;
+	} m_intervalData;
+};
+
+namespace details {
+template <typename Tag, typename T>
+T interval_type_of(const interval_tree_tag<T, Tag>*) noexcept;
+
+template <typename Node, typename Tag>
+struct interval_max_high
+{
+	using value_type = decltype(interval_type_of<Tag>(static_cast<const Node*>(nullptr)));
+	using node_tag = interval_tree_tag<value_type, Tag>;
+	static value_type identity() noexcept { return std::numeric_limits<value_type>::lowest(); }
+	static value_type value(const Node& node) noexcept { return static_cast<const node_tag&>(node).interval_high(); }
+	static value_type combine(const value_type& a, const value_type& b) noexcept { return a < b ? b : a; }
+};
+} // namespace details
+
+/**
+ * @brief Intrusive interval tree, a redblack_tree ordered by interval low augmented with the max interval high.
+ *
+ * Node derives from interval_tree_tag<T, Tag>, and each Tag places a node in one more tree.
+ * Intervals are half-open, [low, high) overlaps [lo, hi) if low < hi and lo < high.
+ * Reporting queries run in O(log n + k) for k reported nodes.
+ */
+template <typename Node, typename Tag>
+class interval_tree : public redblack_tree<Node, Tag, details::interval_max_high<Node, Tag>>
+{
+public:
+	using self = interval_tree<Node, Tag>;
+	using super = redblack_tree<Node, Tag, details::interval_max_high<Node, Tag>>;
+	using typename super::const_iterator;
+	using typename super::iterator;
+	using typename super::node_tag;
+	using typename super::value_type;
+	using interval_type = typename details::interval_max_high<Node, Tag>::value_type;
+	using interval_tag = interval_tree_tag<interval_type, Tag>;
+
+	/// insert node after all nodes of equal interval low
+	iterator insert(Node& node) noexcept
+	{
+		const interval_type& low = itv(node).interval_low();
+		return this->insert_before(
+		  this->partition_point([&low](const value_type& n) { return !(low < itv(n).interval_low()); }), node);
+	}
+
+	/**
+	 * @brief Call fn(node) for every node overlapping [lo, hi), in order of interval low.
+	 */
+	template <typename Fn>
+	void find_overlapping(interval_type lo, interval_type hi, Fn&& fn)
+	{
+		auto report = [&fn](const value_type& node) { fn(const_cast<value_type&>(node)); };
+		search<false>(root_tag(), lo, hi, report);
+	}
+	template <typename Fn>
+	void find_overlapping(interval_type lo, interval_type hi, Fn&& fn) const
+	{
+		search<false>(root_tag(), lo, hi, fn);
+	}
+	/**
+	 * @brief Call fn(node) for every node containing point, in order of interval low.
+	 */
+	template <typename Fn>
+	void stabbing(interval_type point, Fn&& fn)
+	{
+		auto report = [&fn](const value_type& node) { fn(const_cast<value_type&>(node)); };
+		search<true>(root_tag(), point, point, report);
+	}
+	template <typename Fn>
+	void stabbing(interval_type point, Fn&& fn) const
+	{
+		search<true>(root_tag(), point, point, fn);
+	}
+
+	/**
+	 * @brief Some node overlapping [lo, hi) in O(log n), or nullptr if none.
+	 */
+	value_type* any_overlap(interval_type lo, interval_type hi) noexcept
+	{
+		return const_cast<value_type*>(std::as_const(*this).any_overlap(lo, hi));
+	}
+	const value_type* any_overlap(interval_type lo, interval_type hi) const noexcept
+	{
+		const node_tag* n = root_tag();
+		while (n != nullptr) {
+			const interval_tag& t = itv(*n);
+			if (t.interval_low() < hi && lo < t.interval_high())
+				return &static_cast<const value_type&>(*n);
+			// if the left subtree reaches past lo but does not overlap, no node to the right can
+			if (n->left() != nullptr && lo < itv(*n->left()).subtree_high()) {
+				n = n->left();
+			} else {
+				n = n->right();
+			}
+		}
+		return nullptr;
+	}
+
+private:
+	static const interval_tag& itv(const node_tag& node) noexcept
+	{
+		return static_cast<const interval_tag&>(static_cast<const redblack_tree_tag<Tag>&>(node));
+	}
+	static const interval_tag& itv(const value_type& node) noexcept { return static_cast<const interval_tag&>(node); }
+	const node_tag* root_tag() const noexcept { return static_cast<const node_tag*>(this->m_root); }
+
+	/// report in-order, pruning subtrees ending at or before lo and nodes starting at or past hi
+	template <bool Point, typename Fn>
+	void search(const node_tag* node, const interval_type& lo, const interval_type& hi, Fn& fn) const
+	{
+		while (node != nullptr && lo < itv(*node).subtree_high()) {
+			search<Point>(node->left(), lo, hi, fn);
+			const interval_tag& t = itv(*node);
+			if (Point ? hi < t.interval_low() : !(t.interval_low() < hi))
+				return; // every node to the right starts later
+			if (lo < t.interval_high())
+				fn(static_cast<const value_type&>(*node));
+			node = node->right();
+		}
+	}
+};
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_INTERVAL_TREE_HPP
@@ -0,0 +1,332 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_REDBLACK_SET_OPS_HPP
+#define INXLIB_DATA_REDBLACK_SET_OPS_HPP
+
+#include <inxlib/inx.hpp>
+#include <inxlib/util/parallel.hpp>
+
+#include "redblack_tree.hpp"
+
+namespace inx::data {
+
+namespace details {
+struct redblack_discard_none
+{
+	template <typename Node>
+	void operator()(Node&) const noexcept
+	{
+	}
+};
+
+/**
+ * @brief Join-based set operations on detached redblack subtrees.
+ *
+ * A part is the black root of a valid subtree with its black height. Each operation exposes the root of b,
+ * splits a around it, recurses on both sides and joins the results, in O(m log(n/m + 1)).
+ * Both recursions run on their own thread while the thread budget allows and the parts are tall enough.
+ */
+template <typename Tree, typename LessThan, typename Discard>
+struct redblack_set_op
+{
+	using node_type = redblack_tree_node;
+	using base_type = redblack_tree_base;
+	using value_type = typename Tree::value_type;
+	using node_tag = typename Tree::node_tag;
+	/// only fork for parts of black height at least this, about 2^10 nodes
+	static constexpr size_t fork_height = 10;
+
+	struct part
+	{
+		node_type* root;
+		size_t height;
+	};
+	struct result
+	{
+		part tree;
+		size_t count; ///< matched keys
+	};
+	struct split_part
+	{
+		part left;
+		node_type* found;
+		part right;
+	};
+
+	LessThan& lt;
+	Discard& discard;
+	base_type::augment_fn augment;
+
+	static value_type& value(node_type& node) noexcept
+	{
+		return static_cast<value_type&>(static_cast<node_tag&>(node));
+	}
+	static base_type::augment_fn augment_of(const base_type& tree) noexcept { return tree.m_augment; }
+	static part whole(base_type& tree) noexcept
+	{
+		auto* root = static_cast<node_type*>(tree.m_root);
+		return {root, base_type::black_height(root)};
+	}
+
+	part join(part l, node_type& pivot, part r) const noexcept
+	{
+		base_type tree(augment);
+		size_t h = tree.joinRoots(l.root, l.height, pivot, r.root, r.height);
+		return whole_at(tree, h);
+	}
+	part join2(part l, part r) const noexcept
+	{
+		if (r.root == nullptr)
+			return l;
+		auto* first = r.root;
+		while (first->left() != nullptr)
+			first = static_cast<node_type*>(first->left());
+		base_type tree(augment), rest(augment);
+		tree.m_root = r.root;
+		auto heights = tree.splitRoots(*first, rest, false);
+		return join(l, *first, whole_at(rest, heights.second));
+	}
+	/// split t around key, the node equal to key is removed as found
+	split_part split(part t, const value_type& key) const noexcept
+	{
+		node_type* at = nullptr;
+		for (node_type* n = t.root; n != nullptr;) {
+			if (lt(value(*n), key)) {
+				n = static_cast<node_type*>(n->right());
+			} else {
+				at = n;
+				n = static_cast<node_type*>(n->left());
+			}
+		}
+		if (at == nullptr)
+			return {t, nullptr, {nullptr, 0}};
+		const bool found = !lt(key, value(*at));
+		base_type tree(augment), rest(augment);
+		tree.m_root = t.root;
+		auto heights = tree.splitRoots(*at, rest, !found);
+		return {whole_at(tree, heights.first), found ? at : nullptr, whole_at(rest, heights.second)};
+	}
+	/// detach the children of the root of t
+	static std::pair<part, part> expose(part t) noexcept
+	{
+		assert(t.root != nullptr && t.root->is_black());
+		part l{nullptr, t.height - 1}, r{nullptr, t.height - 1};
+		l.root = base_type::detachRoot(static_cast<node_type*>(t.root->left()), l.height);
+		r.root = base_type::detachRoot(static_cast<node_type*>(t.root->right()), r.height);
+		return {l, r};
+	}
+	void discard_all(node_type* root) const
+	{
+		if constexpr (!std::is_same_v<std::remove_cvref_t<Discard>, redblack_discard_none>) {
+			// rotate left children up into a right vine, a node is discarded once it has no left child
+			// and is never read again, so discard may free it
+			while (root != nullptr) {
+				if (root->left() != nullptr) {
+					root = static_cast<node_type*>(&root->rotate_right());
+				} else {
+					auto* next = static_cast<node_type*>(root->right());
+					discard(value(*root));
+					root = next;
+				}
+			}
+		}
+	}
+	static bool fork(part a, part b, uint32 threads) noexcept
+	{
+		return threads > 1 && std::max(a.height, b.height) >= fork_height;
+	}
+
+	/// a with the nodes of b not in a, count is the keys in both
+	result unite(part a, part b, uint32 threads) const
+	{
+		if (b.root == nullptr)
+			return {a, 0};
+		if (a.root == nullptr)
+			return {b, 0};
+		node_type& k = *b.root;
+		auto [bl, br] = expose(b);
+		split_part s = split(a, value(k));
+		result left, right;
+		util::parallel_invoke(
+		  fork(a, b, threads),
+		  [&, bl = bl]() { left = unite(s.left, bl, threads / 2); },
+		  [&, br = br]() { right = unite(s.right, br, threads - threads / 2); });
+		size_t count = left.count + right.count;
+		node_type* pivot = &k;
+		if (s.found != nullptr) {
+			discard(value(k));
+			pivot = s.found;
+			count += 1;
+		}
+		return {join(left.tree, *pivot, right.tree), count};
+	}
+	/// nodes of a also in b, count is the nodes kept
+	result intersect(part a, part b, uint32 threads) const
+	{
+		if (a.root == nullptr || b.root == nullptr) {
+			discard_all(a.root);
+			discard_all(b.root);
+			return {{nullptr, 0}, 0};
+		}
+		node_type& k = *b.root;
+		auto [bl, br] = expose(b);
+		split_part s = split(a, value(k));
+		result left, right;
+		util::parallel_invoke(
+		  fork(a, b, threads),
+		  [&, bl = bl]() { left = intersect(s.left, bl, threads / 2); },
+		  [&, br = br]() { right = intersect(s.right, br, threads - threads / 2); });
+		discard(value(k));
+		if (s.found != nullptr)
+			return {join(left.tree, *s.found, right.tree), left.count + right.count + 1};
+		return {join2(left.tree, right.tree), left.count + right.count};
+	}
+	/// nodes of a not in b, count is the nodes removed
+	result subtract(part a, part b, uint32 threads) const
+	{
+		if (a.root == nullptr) {
+			discard_all(b.root);
+			return {{nullptr, 0}, 0};
+		}
+		if (b.root == nullptr)
+			return {a, 0};
+		node_type& k = *b.root;
+		auto [bl, br] = expose(b);
+		split_part s = split(a, value(k));
+		result left, right;
+		util::parallel_invoke(
+		  fork(a, b, threads),
+		  [&, bl = bl]() { left = subtract(s.left, bl, threads / 2); },
+		  [&, br = br]() { right = subtract(s.right, br, threads - threads / 2); });
+		size_t count = left.count + right.count;
+		discard(value(k));
+		if (s.found != nullptr) {
+			discard(value(*s.found));
+			count += 1;
+		}
+		return {join2(left.tree, right.tree), count};
+	}
+
+	/// store the result into a and empty b
+	static void assign(base_type& a, base_type& b, part tree, size_t size) noexcept
+	{
+		a.m_root = tree.root;
+		a.m_size = size;
+		b.clear();
+	}
+
+private:
+	static part whole_at(base_type& tree, size_t height) noexcept
+	{
+		return {static_cast<node_type*>(tree.m_root), height};
+	}
+};
+} // namespace details
+
+/**
+ * @brief Move every node of b into a, keeping the node of a where both hold an equal key.
+ *
+ * Join-based, in O(m log(n/m + 1)) for sizes m <= n, splicing nodes without copying. b is left empty.
+ * Recursion forks onto new threads within the threads budget once parts exceed a size cutoff.
+ * discard(Node&) is called for each node dropped from b, possibly concurrently from several threads.
+ */
+template <typename Node,
+          typename Tag,
+          typename Augment,
+          typename LessThan = std::less<void>,
+          typename Discard = details::redblack_discard_none>
+void
+tree_union(redblack_tree<Node, Tag, Augment>& a,
+           redblack_tree<Node, Tag, Augment>& b,
+           LessThan&& lt = LessThan(),
+           uint32 threads = 1,
+           Discard&& discard = Discard())
+{
+	assert(&a != &b);
+	using op_type = details::redblack_set_op<redblack_tree<Node, Tag, Augment>, LessThan, Discard>;
+	redblack_tree_base& ab = a;
+	redblack_tree_base& bb = b;
+	op_type op{lt, discard, op_type::augment_of(ab)};
+	auto res = op.unite(op_type::whole(ab), op_type::whole(bb), threads);
+	op_type::assign(ab, bb, res.tree, a.size() + b.size() - res.count);
+}
+
+/**
+ * @brief Keep the nodes of a that have an equal key in b, dropping all others and every node of b.
+ *
+ * Join-based, in O(m log(n/m + 1)) for sizes m <= n. b is left empty.
+ * discard(Node&) is called for each node dropped from a or b, possibly concurrently from several threads.
+ */
+template <typename Node,
+          typename Tag,
+          typename Augment,
+          typename LessThan = std::less<void>,
+          typename Discard = details::redblack_discard_none>
+void
+tree_intersection(redblack_tree<Node, Tag, Augment>& a,
+                  redblack_tree<Node, Tag, Augment>& b,
+                  LessThan&& lt = LessThan(),
+                  uint32 threads = 1,
+                  Discard&& discard = Discard())
+{
+	assert(&a != &b);
+	using op_type = details::redblack_set_op<redblack_tree<Node, Tag, Augment>, LessThan, Discard>;
+	redblack_tree_base& ab = a;
+	redblack_tree_base& bb = b;
+	op_type op{lt, discard, op_type::augment_of(ab)};
+	auto res = op.intersect(op_type::whole(ab), op_type::whole(bb), threads);
+	op_type::assign(ab, bb, res.tree, res.count);
+}
+
+/**
+ * @brief Drop the nodes of a that have an equal key in b, and every node of b.
+ *
+ * Join-based, in O(m log(n/m + 1)) for sizes m <= n. b is left empty.
+ * discard(Node&) is called for each node dropped from a or b, possibly concurrently from several threads.
+ */
+template <typename Node,
+          typename Tag,
+          typename Augment,
+          typename LessThan = std::less<void>,
+          typename Discard = details::redblack_discard_none>
+void
+tree_difference(redblack_tree<Node, Tag, Augment>& a,
+                redblack_tree<Node, Tag, Augment>& b,
+                LessThan&& lt = LessThan(),
+                uint32 threads = 1,
+                Discard&& discard = Discard())
+{
+	assert(&a != &b);
+	using op_type = details::redblack_set_op<redblack_tree<Node, Tag, Augment>, LessThan, Discard>;
+	redblack_tree_base& ab = a;
+	redblack_tree_base& bb = b;
+	op_type op{lt, discard, op_type::augment_of(ab)};
+	auto res = op.subtract(op_type::whole(ab), op_type::whole(bb), threads);
+	op_type::assign(ab, bb, res.tree, a.size() - res.count);
+}
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_REDBLACK_SET_OPS_HPP
@@ -25,20 +25,31 @@ SOFTWARE.
 #ifndef INXLIB_DATA_REDBLACK_TREE_HPP
 #define INXLIB_DATA_REDBLACK_TREE_HPP
 
+#include <array>
+#include <bit>
 #include <inxlib/inx.hpp>
+#include <iterator>
 
 #include "binary_tree.hpp"
 
 namespace inx::data {
 
-template <typename Node, typename Tag = void>
+template <typename Node, typename Tag = void, typename Augment = void>
 class redblack_tree;
 class redblack_tree_base;
 struct redblack_tree_node;
 template <typename Tag = void>
 struct redblack_tree_tag;
+template <typename Tag = void>
+struct redblack_tree_order_tag;
+template <typename T, typename Tag = void>
+struct redblack_tree_aggregate_tag;
 template <typename Tree, typename Node>
 class redblack_tree_iterator;
+namespace details {
+template <typename Tree, typename LessThan, typename Discard>
+struct redblack_set_op;
+} // namespace details
 
 struct redblack_tree_node : binary_tree_node
 {
@@ -111,12 +122,88 @@ struct redblack_tree_tag : redblack_tree_node
 	}
 };
 
+/**
+ * @brief A redblack_tree_tag that also keeps the size of its subtree.
+ *
+ * Deriving Node from redblack_tree_order_tag<Tag> instead of redblack_tree_tag<Tag> enables the
+ * order statistics of redblack_tree<Node, Tag>, select, rank and O(log n) iterator distance.
+ */
+template <typename Tag>
+struct redblack_tree_order_tag : redblack_tree_tag<Tag>
+{
+	using self = redblack_tree_order_tag<Tag>;
+	using super = redblack_tree_tag<Tag>;
+	using order_node = self;
+
+	size_t subtree_size() const noexcept { return m_orderData.size; }
+	static size_t subtree_size(const super* node) noexcept
+	{
+		return node != nullptr ? static_cast<const self*>(node)->m_orderData.size : 0;
+	}
+
+	struct OrderData
+	{
+		size_t size;
+	} m_orderData;
+};
+
+/**
+ * @brief A redblack_tree_order_tag that also keeps an aggregate of type T over its subtree.
+ *
+ * Used with redblack_tree<Node, Tag, Augment>, where Augment defines the aggregate as a monoid.
+ */
+template <typename T, typename Tag>
+struct redblack_tree_aggregate_tag : redblack_tree_order_tag<Tag>
+{
+	using self = redblack_tree_aggregate_tag<T, Tag>;
+	using super = redblack_tree_order_tag<Tag>;
+	using aggregate_node = self;
+	using aggregate_type = T;
+
+	const T& subtree_aggregate() const noexcept { return m_aggregateData.value; }
+	static const T& subtree_aggregate(const redblack_tree_tag<Tag>* node) noexcept
+	{
+		assert(node != nullptr);
+		return static_cast<const self*>(node)->m_aggregateData.value;
+	}
+
+	struct AggregateData
+	{
+		T value;
+	} m_aggregateData;
+};
+
+/**
+ * @brief Policy for the subtree aggregate of redblack_tree<Node, Tag, Augment>.
+ *
+ * The aggregate of a subtree is the in-order fold combine(left, value(node), right), so combine
+ * must be associative with identity() as its identity, but need not be commutative.
+ */
+template <typename Augment, typename Node>
+concept redblack_tree_augment = requires(const Node& node, const typename Augment::value_type& a) {
+	typename Augment::value_type;
+	{ Augment::identity() } -> std::convertible_to<typename Augment::value_type>;
+	{ Augment::value(node) } -> std::convertible_to<typename Augment::value_type>;
+	{ Augment::combine(a, a) } -> std::convertible_to<typename Augment::value_type>;
+};
+
 class redblack_tree_base : public binary_tree_base
 {
 public:
 	using self = redblack_tree_base;
 	using super = binary_tree_base;
 	using value_type = redblack_tree_node;
+	/// recompute the augmented data of a node from its children
+	using augment_fn = void (*)(value_type& node) noexcept;
+
+	redblack_tree_base() noexcept
+	  : m_augment(nullptr)
+	{
+	}
+	explicit redblack_tree_base(augment_fn augment) noexcept
+	  : m_augment(augment)
+	{
+	}
 
 	void insert_root(value_type& node) noexcept { insertRootNode(node); }
 
@@ -151,7 +238,36 @@ public:
 	static bool is_node_black(const value_type* node) noexcept { return node == nullptr ? true : node->is_black(); }
 	static bool is_node_red(const value_type* node) noexcept { return node == nullptr ? false : node->is_red(); }
 
+	template <typename Tree, typename LessThan, typename Discard>
+	friend struct details::redblack_set_op;
+
+	/// rotate as binary_tree_base, then recompute the augmented data of the two rotated nodes
+	void rotate_id(value_type& node, size_t i) noexcept
+	{
+		super::rotate_id(node, i);
+		if (m_augment != nullptr) {
+			m_augment(node);
+			m_augment(static_cast<value_type&>(*node.parent()));
+		}
+	}
+	void rotate_left(value_type& node) noexcept { rotate_id(node, 0); }
+	void rotate_right(value_type& node) noexcept { rotate_id(node, 1); }
+
 protected:
+	void augment_node(value_type& node) noexcept
+	{
+		if (m_augment != nullptr)
+			m_augment(node);
+	}
+	/// recompute the augmented data from node up to the root
+	void augment_path(value_type* node) noexcept
+	{
+		if (m_augment != nullptr) {
+			for (; node != nullptr; node = static_cast<value_type*>(node->parent()))
+				m_augment(*node);
+		}
+	}
+
 	void swap_node(value_type& node1, value_type& node2) noexcept
 	{
 		assert(&node1 != &node2);
@@ -183,6 +299,22 @@ protected:
 		assert(node2.parent() == nullptr ? this->m_root == &node2 : node2.parent()->children_connected());
 		assert(node1.children_connected());
 		assert(node2.children_connected());
+		if (m_augment != nullptr) { // the path from the lower node passes through the upper
+			if (is_ancestor(node1, node2)) {
+				augment_path(&node2);
+			} else {
+				augment_path(&node1);
+				if (!is_ancestor(node2, node1))
+					augment_path(&node2);
+			}
+		}
+	}
+	static bool is_ancestor(const value_type& upper, const value_type& lower) noexcept
+	{
+		for (auto* n = lower.parent(); n != nullptr; n = n->parent())
+			if (n == &upper)
+				return true;
+		return false;
 	}
 
 	void insertRootNode(value_type& node) noexcept
@@ -192,6 +324,7 @@ protected:
 		this->m_size += 1;
 		node.m_nData.parent = node.m_nData.children[0] = node.m_nData.children[1] = nullptr;
 		node.m_rbData.red = false;
+		augment_node(node);
 	}
 	void insertUnderLeafNode(value_type& leaf, size_t i, value_type& node) noexcept
 	{
@@ -201,16 +334,19 @@ protected:
 		leaf.connect_child(node, i);
 		node.m_nData.children[0] = node.m_nData.children[1] = nullptr;
 		node.m_rbData.red = true;
+		augment_path(&node); // rotations in insertNormalise keep the path up to date
 		insertNormalise(&node);
 	}
-	void insertNormalise(value_type* node) noexcept
+	/// returns true if the root was recoloured black, growing the black height of the tree
+	bool insertNormalise(value_type* node) noexcept
 	{
 		while (true) {
 			if (node->is_root()) {
+				bool grew = node->m_rbData.red;
 				node->m_rbData.red = false;
-				break;
+				return grew;
 			} else if (auto p = static_cast<value_type*>(node->parent()); p->is_black()) {
-				break;
+				return false;
 			} else {
 				auto gp = static_cast<value_type*>(p->parent());
 				assert(gp != nullptr);                                 // only root parent can be nullptr, but root
@@ -227,17 +363,120 @@ protected:
 					if (nid != pid) { // if rotating grand parent will result
 						              // in invalid tree, do inital rotate
 						gp->connect_child(p->rotate_id(pid), pid);
+						augment_node(*p);
+						augment_node(*node);
 						p = node;
 					}
 					this->rotate_id(*gp, pid ^ 1);
 					p->m_rbData.red = false;
 					gp->m_rbData.red = true;
-					break;
+					return false;
 				}
 			}
 		}
 	}
 
+	/// black nodes on a path from node to a leaf, including node
+	static size_t black_height(const value_type* node) noexcept
+	{
+		size_t h = 0;
+		for (; node != nullptr; node = static_cast<const value_type*>(node->left()))
+			h += static_cast<size_t>(node->is_black());
+		return h;
+	}
+	/// detach a subtree as the root of its own tree, recolouring it black
+	static value_type* detachRoot(value_type* node, size_t& height) noexcept
+	{
+		if (node != nullptr) {
+			node->make_root();
+			if (node->is_red()) {
+				node->m_rbData.red = false;
+				height += 1;
+			}
+		}
+		return node;
+	}
+	/**
+	 * @brief Make m_root the join of left, pivot and right, each with black root and the given black height.
+	 *
+	 * The pivot is placed down the spine of the taller tree where the black heights match, then normalised
+	 * as an inserted node, in O(|lh - rh| + 1). Returns the black height of the result. m_size is unchanged.
+	 */
+	size_t joinRoots(value_type* left, size_t lh, value_type& pivot, value_type* right, size_t rh) noexcept
+	{
+		pivot.m_nData.parent = nullptr;
+		if (lh == rh) {
+			pivot.m_nData.children[0] = pivot.m_nData.children[1] = nullptr;
+			pivot.connect_child_auto(left, 0);
+			pivot.connect_child_auto(right, 1);
+			pivot.m_rbData.red = false;
+			this->m_root = &pivot;
+			augment_node(pivot);
+			return lh + 1;
+		}
+		const size_t side = lh > rh ? 1 : 0; // descend the spine of the taller tree facing the shorter
+		value_type* tall = side ? left : right;
+		value_type* other = side ? right : left;
+		size_t h = std::max(lh, rh);
+		const size_t target = std::min(lh, rh);
+		value_type* p = nullptr;
+		value_type* c = tall;
+		while (!is_node_black(c) || h != target) {
+			h -= static_cast<size_t>(c->is_black());
+			p = c;
+			c = static_cast<value_type*>(c->child(side));
+		}
+		assert(p != nullptr);
+		this->m_root = tall;
+		p->connect_child(pivot, side);
+		pivot.m_nData.children[0] = pivot.m_nData.children[1] = nullptr;
+		pivot.connect_child_auto(c, side ^ 1);
+		pivot.connect_child_auto(other, side);
+		pivot.m_rbData.red = true;
+		augment_path(&pivot);
+		return std::max(lh, rh) + static_cast<size_t>(insertNormalise(&pivot));
+	}
+	/**
+	 * @brief Split into the nodes before at, kept in m_root, and at onwards, moved to right.m_root.
+	 *
+	 * Walks from at to the root, joining each ancestor and its other subtree onto the side it belongs to.
+	 * The black heights joined along each side only grow, so the total work is O(log n). m_size is unchanged.
+	 * If include_at is false, at is unlinked from both sides. Returns the black heights of both sides.
+	 */
+	std::pair<size_t, size_t> splitRoots(value_type& at, self& right, bool include_at = true) noexcept
+	{
+		size_t h = black_height(&at); // black height of child before the split
+		value_type* child = &at;
+		value_type* p = static_cast<value_type*>(at.parent());
+		size_t lh = h - static_cast<size_t>(at.is_black()), rh = lh;
+		value_type* l = detachRoot(static_cast<value_type*>(at.left()), lh);
+		value_type* r = detachRoot(static_cast<value_type*>(at.right()), rh);
+		if (include_at) {
+			rh = right.joinRoots(nullptr, 0, at, r, rh);
+		} else {
+			right.m_root = r;
+			at.m_nData.parent = at.m_nData.children[0] = at.m_nData.children[1] = nullptr;
+		}
+		while (p != nullptr) {
+			const size_t ph = h + static_cast<size_t>(p->is_black());
+			const size_t side = p->get_child_id(*child);
+			auto* gp = static_cast<value_type*>(p->parent());
+			size_t sh = h;
+			value_type* sib = detachRoot(static_cast<value_type*>(p->child(side ^ 1)), sh);
+			if (side == 0) {
+				rh = right.joinRoots(static_cast<value_type*>(right.m_root), rh, *p, sib, sh);
+			} else {
+				lh = this->joinRoots(sib, sh, *p, l, lh);
+				l = static_cast<value_type*>(this->m_root);
+			}
+			child = p;
+			h = ph;
+			p = gp;
+		}
+		this->m_root = l;
+		return {lh, rh};
+	}
+
 	void eraseNode(value_type& node) noexcept
 	{
 		m_size -= 1;
@@ -268,6 +507,7 @@ protected:
 		if (c == nullptr) {           // node is leaf
 			if (node.is_red()) {      // node is a red leaf, can just delete
 				p->connect_none(nid); // remove node
+				augment_path(p);
 				return;
 			}
 			// otherwise, more complicated delete required
@@ -276,6 +516,7 @@ protected:
 				                                    // parent, make it black
 				p->connect_child(*c, nid);
 				c->m_rbData.red = false;
+				augment_path(p);
 				return;
 			}
 		}
@@ -283,6 +524,7 @@ protected:
 		                        // a leaf
 		// since node is leaf, just delete it for now, keep track of parent
 		p->connect_none(nid);
+		augment_path(p); // rotations in eraseNodeNormalise keep the path up to date
 		// now rebalance the tree
 		eraseNodeNormalise(p, nid);
 	}
@@ -348,6 +590,8 @@ protected:
 			}
 		}
 	}
+
+	augment_fn m_augment;
 };
 
 template <typename Tree, typename Node>
@@ -438,6 +682,38 @@ public:
 		return cp;
 	}
 
+	// O(log n) movement for order statistic trees
+	self& operator+=(difference_type n) noexcept
+	  requires std::remove_const_t<tree_type>::order_statistic
+	{
+		assert(m_tree != nullptr);
+		*this = m_tree->advance(*this, n);
+		return *this;
+	}
+	self& operator-=(difference_type n) noexcept
+	  requires std::remove_const_t<tree_type>::order_statistic
+	{
+		return *this += -n;
+	}
+	self operator+(difference_type n) const noexcept
+	  requires std::remove_const_t<tree_type>::order_statistic
+	{
+		auto cp = *this;
+		return cp += n;
+	}
+	self operator-(difference_type n) const noexcept
+	  requires std::remove_const_t<tree_type>::order_statistic
+	{
+		auto cp = *this;
+		return cp -= n;
+	}
+	difference_type operator-(const self& rhs) const noexcept
+	  requires std::remove_const_t<tree_type>::order_statistic
+	{
+		assert(m_tree != nullptr && m_tree == rhs.m_tree);
+		return m_tree->distance(rhs, *this);
+	}
+
 	tree_type* tree() noexcept { return m_tree; }
 	const tree_type* tree() const noexcept { return m_tree; }
 	pointer node() noexcept { return m_node; }
@@ -448,11 +724,11 @@ private:
 	value_type* m_node;
 };
 
-template <typename Node, typename Tag>
+template <typename Node, typename Tag, typename Augment>
 class redblack_tree : public redblack_tree_base
 {
 public:
-	using self = redblack_tree<Node, Tag>;
+	using self = redblack_tree<Node, Tag, Augment>;
 	using super = redblack_tree_base;
 	using value_type = Node;
 	using tag = Tag;
@@ -461,6 +737,22 @@ public:
 	using const_iterator = redblack_tree_iterator<std::add_const_t<self>, std::add_const_t<value_type>>;
 	using reverse_iterator = std::reverse_iterator<iterator>;
 	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+	using order_tag = redblack_tree_order_tag<tag>;
+	/// Node derives from redblack_tree_order_tag<Tag>, enables select, rank and O(log n) distance
+	static constexpr bool order_statistic = std::derived_from<value_type, order_tag>;
+	using augment_type = Augment;
+	/// Augment is a redblack_tree_augment policy, enables aggregate queries
+	static constexpr bool augmented = !std::is_void_v<Augment>;
+
+	redblack_tree() noexcept
+	  : super(order_statistic ? &update_order : nullptr)
+	{
+		if constexpr (augmented) {
+			static_assert(redblack_tree_augment<Augment, Node>, "Augment must satisfy redblack_tree_augment");
+			static_assert(std::derived_from<value_type, aggregate_tag<typename Augment::value_type>>,
+			              "Node must derive from redblack_tree_aggregate_tag<Augment::value_type, Tag>");
+		}
+	}
 
 	// mary_tree interface
 	value_type& root() noexcept { return static_cast<value_type&>(static_cast<node_tag&>(super::root())); }
@@ -631,6 +923,240 @@ public:
 		return node;
 	}
 
+	// order statistics, requires order_statistic
+	/// the k-th node in order, or end() if k >= size()
+	iterator select(size_t k) noexcept
+	  requires order_statistic
+	{
+		return iterator(*this, const_cast<value_type*>(std::as_const(*this).select(k).node()));
+	}
+	const_iterator select(size_t k) const noexcept
+	  requires order_statistic
+	{
+		const node_tag* node = static_cast<const node_tag*>(this->m_root);
+		while (node != nullptr) {
+			size_t left = order_tag::subtree_size(node->left());
+			if (k < left) {
+				node = node->left();
+			} else if (k == left) {
+				break;
+			} else {
+				k -= left + 1;
+				node = node->right();
+			}
+		}
+		return const_iterator(*this, node != nullptr ? &static_cast<const value_type&>(*node) : nullptr);
+	}
+	/// the in-order position of node
+	size_t rank(const Node& node) const noexcept
+	  requires order_statistic
+	{
+		const node_tag* n = &static_cast<const node_tag&>(node);
+		size_t r = order_tag::subtree_size(n->left());
+		for (const node_tag* p = n->parent(); p != nullptr; n = p, p = p->parent()) {
+			if (p->right() == n)
+				r += order_tag::subtree_size(p->left()) + 1;
+		}
+		return r;
+	}
+	/// the in-order position of it, size() for end()
+	size_t rank(const_iterator it) const noexcept
+	  requires order_statistic
+	{
+		assert(it.tree() == this);
+		return it != nullptr ? rank(*it) : this->m_size;
+	}
+	template <typename It>
+	ptrdiff_t distance(It first, It last) const noexcept
+	  requires order_statistic
+	{
+		return static_cast<ptrdiff_t>(rank(as_const_iterator(last))) -
+		       static_cast<ptrdiff_t>(rank(as_const_iterator(first)));
+	}
+	iterator advance(iterator it, ptrdiff_t n) noexcept
+	  requires order_statistic
+	{
+		assert(it.tree() == this);
+		return select(static_cast<size_t>(static_cast<ptrdiff_t>(rank(as_const_iterator(it))) + n));
+	}
+	const_iterator advance(const_iterator it, ptrdiff_t n) const noexcept
+	  requires order_statistic
+	{
+		assert(it.tree() == this);
+		return select(static_cast<size_t>(static_cast<ptrdiff_t>(rank(it)) + n));
+	}
+
+	// subtree aggregates, requires augmented
+	/// aggregate of the whole tree
+	auto aggregate() const noexcept
+	  requires augmented
+	{
+		using T = typename Augment::value_type;
+		return this->m_root != nullptr ? T(agg_of(static_cast<const node_tag*>(this->m_root))) : T(Augment::identity());
+	}
+	/// aggregate of [first, last) in O(log n)
+	template <typename It>
+	auto aggregate(It first, It last) const noexcept
+	  requires augmented
+	{
+		return aggregate_rank(rank(as_const_iterator(first)), rank(as_const_iterator(last)));
+	}
+	/// aggregate of the nodes with in-order position in [first, last) in O(log n)
+	auto aggregate_rank(size_t first, size_t last) const noexcept
+	  requires augmented
+	{
+		using T = typename Augment::value_type;
+		last = std::min(last, this->m_size);
+		if (first >= last)
+			return T(Augment::identity());
+		last -= 1; // inclusive
+		// descend to the node where first and last split
+		const node_tag* node = static_cast<const node_tag*>(this->m_root);
+		size_t lo = 0;
+		while (true) {
+			assert(node != nullptr);
+			size_t pos = lo + order_tag::subtree_size(node->left());
+			if (last < pos) {
+				node = node->left();
+			} else if (first > pos) {
+				lo = pos + 1;
+				node = node->right();
+			} else {
+				break;
+			}
+		}
+		T ans = Augment::value(static_cast<const value_type&>(*node));
+		// left side, suffix of positions >= first, pieces found from the right
+		size_t split = lo + order_tag::subtree_size(node->left());
+		size_t llo = lo;
+		for (const node_tag* n = node->left(); n != nullptr;) {
+			size_t pos = llo + order_tag::subtree_size(n->left());
+			if (first <= pos) {
+				ans = Augment::combine(Augment::value(static_cast<const value_type&>(*n)),
+				                       n->right() != nullptr ? T(Augment::combine(agg_of(n->right()), ans)) : ans);
+				n = n->left();
+			} else {
+				llo = pos + 1;
+				n = n->right();
+			}
+		}
+		// right side, prefix of positions <= last, pieces found from the left
+		size_t rlo = split + 1;
+		for (const node_tag* n = node->right(); n != nullptr;) {
+			size_t pos = rlo + order_tag::subtree_size(n->left());
+			if (last >= pos) {
+				ans = Augment::combine(n->left() != nullptr ? T(Augment::combine(ans, agg_of(n->left()))) : ans,
+				                       Augment::value(static_cast<const value_type&>(*n)));
+				rlo = pos + 1;
+				n = n->right();
+			} else {
+				n = n->left();
+			}
+		}
+		return ans;
+	}
+
+	/**
+	 * @brief Replace the contents with the nodes of [first, last), already in order, in O(n).
+	 *
+	 * The range dereferences to Node& or Node*, nodes previously in the tree are discarded.
+	 * Nodes take the in-order positions of a complete binary tree with the bottom level filled from the left,
+	 * the bottom level coloured red and all others black. Links are made in one pass with a node per level,
+	 * without comparisons or recursion.
+	 */
+	template <std::forward_iterator It>
+	void assign_sorted(It first, It last) noexcept
+	{
+		this->m_root = nullptr;
+		this->m_size = static_cast<size_t>(std::distance(first, last));
+		const size_t n = this->m_size;
+		if (n == 0)
+			return;
+		const int levels = std::bit_width(n);
+		const size_t top = size_t{1} << (levels - 1);  // root position, 1-based in a perfect tree
+		const size_t bottom_end = 2 * (n - (top - 1)); // positions below bottom_end are all present
+		auto present = [bottom_end](size_t j) { return (j & 1) == 0 || j < bottom_end; };
+		std::array<redblack_tree_node*, std::numeric_limits<size_t>::digits> level_last;
+		for (size_t i = 0; first != last; ++first, ++i) {
+			redblack_tree_node& node = static_cast<node_tag&>(deref_node(*first));
+			const size_t j = i < bottom_end ? i + 1 : 2 * (i - bottom_end / 2 + 1);
+			const int k = std::countr_zero(j);
+			node.m_nData.parent = node.m_nData.children[0] = node.m_nData.children[1] = nullptr;
+			node.m_rbData.red = k == 0 && levels > 1;
+			if (k > 0 && present(j - (size_t{1} << (k - 1))))
+				node.connect_child(*level_last[k - 1], 0);
+			if (j == top) {
+				this->m_root = &node;
+			} else if (j & (size_t{2} << k)) { // right child, the parent came before
+				level_last[k + 1]->connect_child(node, 1);
+			}
+			level_last[k] = &node;
+			// node completes its subtree if it has no right child, and then each parent it is the right child of
+			if (this->m_augment != nullptr && (k == 0 || !present(j + (size_t{1} << (k - 1))))) {
+				redblack_tree_node* c = &node;
+				this->m_augment(*c);
+				for (auto* p = static_cast<redblack_tree_node*>(c->parent()); p != nullptr && p->right() == c;
+				     c = p, p = static_cast<redblack_tree_node*>(p->parent()))
+					this->m_augment(*p);
+			}
+		}
+	}
+
+	/**
+	 * @brief Append pivot and then all nodes of right, leaving right empty, in O(log n).
+	 *
+	 * Every node of this tree must order before pivot, and pivot before every node of right.
+	 */
+	void join(Node& pivot, self& right) noexcept
+	{
+		assert(&right != this);
+		auto* l = static_cast<redblack_tree_node*>(this->m_root);
+		auto* r = static_cast<redblack_tree_node*>(right.m_root);
+		this->joinRoots(l, black_height(l), static_cast<node_tag&>(pivot), r, black_height(r));
+		this->m_size += 1 + right.m_size;
+		right.clear();
+	}
+	/**
+	 * @brief Append all nodes of right, leaving right empty, in O(log n).
+	 */
+	void join2(self& right) noexcept
+	{
+		if (right.empty())
+			return;
+		join(right.erase(right.front()), right);
+	}
+	/**
+	 * @brief Move the nodes from at onwards into the returned tree, in O(log n).
+	 *
+	 * The size of the moved part comes from the subtree sizes of order statistic trees, otherwise it is
+	 * counted from at towards both ends, costing O(min(k, n - k)) for k moved nodes.
+	 */
+	self split(iterator at) noexcept
+	{
+		assert(at.tree() == this);
+		self right;
+		if (at == nullptr)
+			return right;
+		size_t count;
+		if constexpr (order_statistic) {
+			count = this->m_size - rank(*at);
+		} else {
+			count = split_count(*at);
+		}
+		this->splitRoots(static_cast<node_tag&>(*at), right);
+		right.m_size = count;
+		this->m_size -= count;
+		return right;
+	}
+	/**
+	 * @brief Move the nodes not less than key into the returned tree, in O(log n).
+	 */
+	template <typename Key, typename LessThan = std::less<void>>
+	self split(const Key& key, LessThan&& lt = LessThan()) noexcept
+	{
+		return split(lower_bound(key, std::forward<LessThan>(lt)));
+	}
+
 	iterator begin() noexcept { return iterator(*this, this->m_root != nullptr ? &this->front() : nullptr); }
 	const_iterator begin() const noexcept
 	{
@@ -646,6 +1172,54 @@ public:
 	reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
 	const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
 	const_reverse_iterator crend() const noexcept { return rend(); }
+
+private:
+	/// nodes from at to the end, counted towards both ends until one is reached
+	size_t split_count(Node& at) const noexcept
+	{
+		const redblack_tree_node* fwd = &static_cast<node_tag&>(at);
+		const redblack_tree_node* bwd = fwd;
+		for (size_t i = 0;; ++i) {
+			fwd = static_cast<const redblack_tree_node*>(fwd->find_inorder_id(0));
+			if (fwd == nullptr)
+				return i + 1;
+			bwd = static_cast<const redblack_tree_node*>(bwd->find_inorder_id(1));
+			if (bwd == nullptr)
+				return this->m_size - i;
+		}
+	}
+
+	static Node& deref_node(Node& node) noexcept { return node; }
+	static Node& deref_node(Node* node) noexcept { return *node; }
+
+	const_iterator as_const_iterator(const_iterator it) const noexcept { return it; }
+	const_iterator as_const_iterator(iterator it) const noexcept { return const_iterator(*this, it.node()); }
+
+	template <typename T>
+	using aggregate_tag = redblack_tree_aggregate_tag<T, tag>;
+
+	static decltype(auto) agg_of(const node_tag* node) noexcept
+	{
+		return aggregate_tag<typename Augment::value_type>::subtree_aggregate(node);
+	}
+
+	static void update_order(redblack_tree_node& node) noexcept
+	{
+		if constexpr (order_statistic) {
+			auto& n = static_cast<order_tag&>(static_cast<node_tag&>(node));
+			n.m_orderData.size = 1 + order_tag::subtree_size(n.left()) + order_tag::subtree_size(n.right());
+			if constexpr (augmented) {
+				using T = typename Augment::value_type;
+				auto& v = static_cast<const value_type&>(n);
+				T a = Augment::value(v);
+				if (n.left() != nullptr)
+					a = Augment::combine(agg_of(n.left()), a);
+				if (n.right() != nullptr)
+					a = Augment::combine(a, agg_of(n.right()));
+				static_cast<aggregate_tag<T>&>(n).m_aggregateData.value = std::move(a);
+			}
+		}
+	}
 };
 
 } // namespace inx::data
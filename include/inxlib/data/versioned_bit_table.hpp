@@ -0,0 +1,268 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_DATA_VERSIONED_BIT_TABLE_HPP
+#define INXLIB_DATA_VERSIONED_BIT_TABLE_HPP
+
+#include <atomic>
+#include <inxlib/inx.hpp>
+#include <inxlib/util/bits.hpp>
+#include <thread>
+#include <vector>
+
+#include "bit_table.hpp"
+
+namespace inx::data {
+
+/**
+ * @brief Double buffered bit_table, with many lock-free readers and a single writer.
+ *
+ * Readers take a snapshot of the published table, which stays valid and unchanged until released.
+ * The writer edits the back table, marks the rows it changed, then publishes with an atomic swap.
+ * The previous table becomes the new back table once its readers have released it,
+ * and is brought up to date by copying only the rows marked dirty.
+ *
+ * Readers pin a table by incrementing a counter in one of reader_slots cache-line sized slots,
+ * picked per thread, so readers on different threads rarely touch the same cache line.
+ * The writer sums the slots of the back table to know when it has been released.
+ * edit and publish block, yielding, until every snapshot of the previous table is released,
+ * so long-held snapshots stall the writer; try_edit checks without blocking.
+ *
+ * The writer functions edit, mark_dirty and publish must only be called from a single thread.
+ * The table dimensions are fixed at construction.
+ */
+template <size_t BitCount = 1, size_t BufferSize = 0, std::unsigned_integral PackType = size_t>
+class versioned_bit_table
+{
+public:
+	using table_type = bit_table<BitCount, BufferSize, PackType>;
+	static constexpr size_t buffer_size = BufferSize;
+	/// reader counter slots, threads beyond this share slots
+	static constexpr size_t reader_slots = 32;
+
+protected:
+	struct Buffer
+	{
+		table_type table;
+		uint64 version;
+	};
+	/// per slot reader counts of both buffers, on their own cache line
+	struct alignas(table_type::cells_alignment) ReaderSlot
+	{
+		std::atomic<uint32> readers[2];
+	};
+
+public:
+	class snapshot
+	{
+	public:
+		snapshot() noexcept
+		  : m_buffer(nullptr)
+		  , m_pin(nullptr)
+		{
+		}
+		snapshot(const snapshot&) = delete;
+		snapshot(snapshot&& other) noexcept
+		  : m_buffer(std::exchange(other.m_buffer, nullptr))
+		  , m_pin(std::exchange(other.m_pin, nullptr))
+		{
+		}
+		~snapshot() { release(); }
+		snapshot& operator=(const snapshot&) = delete;
+		snapshot& operator=(snapshot&& other) noexcept
+		{
+			if (this != &other) {
+				release();
+				m_buffer = std::exchange(other.m_buffer, nullptr);
+				m_pin = std::exchange(other.m_pin, nullptr);
+			}
+			return *this;
+		}
+
+		void release() noexcept
+		{
+			if (m_buffer != nullptr) {
+				m_pin->fetch_sub(1, std::memory_order_release);
+				m_buffer = nullptr;
+				m_pin = nullptr;
+			}
+		}
+
+		explicit operator bool() const noexcept { return m_buffer != nullptr; }
+		const table_type& operator*() const noexcept { return m_buffer->table; }
+		const table_type* operator->() const noexcept { return &m_buffer->table; }
+		const table_type& table() const noexcept { return m_buffer->table; }
+		uint64 version() const noexcept { return m_buffer->version; }
+
+	protected:
+		friend class versioned_bit_table;
+		snapshot(Buffer* buffer, std::atomic<uint32>* pin) noexcept
+		  : m_buffer(buffer)
+		  , m_pin(pin)
+		{
+		}
+		Buffer* m_buffer;
+		std::atomic<uint32>* m_pin; ///< the slot counter holding buffer
+	};
+
+	versioned_bit_table(uint32 width, uint32 height, std::pmr::memory_resource* res = nullptr)
+	  : m_buffers{{table_type(width, height, res), 0}, {table_type(width, height, res), 0}}
+	  , m_back(&m_buffers[1])
+	  , m_synced(true)
+	{
+		for (auto& slot : m_slots) {
+			slot.readers[0].store(0, std::memory_order_relaxed);
+			slot.readers[1].store(0, std::memory_order_relaxed);
+		}
+		size_t rows = height + 2 * buffer_size;
+		m_dirty.assign((rows + 63) >> 6, 0);
+		m_stale.assign((rows + 63) >> 6, 0);
+		m_front.store(&m_buffers[0]);
+	}
+	versioned_bit_table(const versioned_bit_table&) = delete;
+	versioned_bit_table(versioned_bit_table&&) = delete;
+	~versioned_bit_table() { assert(reader_count(0) == 0 && reader_count(1) == 0); }
+
+	/**
+	 * @brief Pin the currently published table for reading, lock-free.
+	 */
+	snapshot read() const noexcept
+	{
+		ReaderSlot& slot = m_slots[thread_slot()];
+		while (true) {
+			Buffer* b = m_front.load();
+			std::atomic<uint32>& pin = slot.readers[b - m_buffers];
+			pin.fetch_add(1);
+			// validate b is still published, otherwise the writer may already own it
+			if (m_front.load() == b)
+				return snapshot(b, &pin);
+			pin.fetch_sub(1);
+		}
+	}
+
+	/**
+	 * @brief The back table for the writer to modify.
+	 *        Waits for readers of a previously published table to release it,
+	 *        then copies in the rows changed since.
+	 */
+	table_type& edit()
+	{
+		if (!m_synced) {
+			while (reader_count(m_back - m_buffers) != 0)
+				std::this_thread::yield();
+			sync_back();
+			m_synced = true;
+		}
+		return m_back->table;
+	}
+	/// if the back table is free without waiting, returns it like edit, otherwise nullptr
+	table_type* try_edit()
+	{
+		if (!m_synced && reader_count(m_back - m_buffers) != 0)
+			return nullptr;
+		return &edit();
+	}
+
+	/// marks row y of the back table as changed, y may be in the buffer
+	void mark_dirty(int32 y) noexcept
+	{
+		size_t r = static_cast<size_t>(y + static_cast<int32>(buffer_size));
+		assert(r < m_back->table.getPadHeight());
+		m_dirty[r >> 6] |= uint64{1} << (r & 63);
+	}
+	/// marks rows [y, y+height) of the back table as changed
+	void mark_dirty(int32 y, int32 height) noexcept
+	{
+		for (int32 i = y, ie = y + height; i < ie; ++i)
+			mark_dirty(i);
+	}
+	void mark_all_dirty() noexcept { std::fill(m_dirty.begin(), m_dirty.end(), ~uint64{0}); }
+
+	/**
+	 * @brief Publish the back table to readers with an atomic swap.
+	 *        The previously published table becomes the back table.
+	 */
+	void publish()
+	{
+		edit(); // ensure back table has been synced
+		Buffer* front = m_front.load(std::memory_order_relaxed);
+		m_back->version = front->version + 1;
+		m_front.store(m_back);
+		m_back = front;
+		std::swap(m_dirty, m_stale);
+		std::fill(m_dirty.begin(), m_dirty.end(), 0);
+		m_synced = false;
+	}
+
+	uint64 version() const noexcept { return m_front.load()->version; }
+
+protected:
+	/// slot of the calling thread, assigned round robin on first use
+	static size_t thread_slot() noexcept
+	{
+		static std::atomic<size_t> next{0};
+		thread_local const size_t slot = next.fetch_add(1, std::memory_order_relaxed) % reader_slots;
+		return slot;
+	}
+	uint32 reader_count(ptrdiff_t buffer) const noexcept
+	{
+		uint32 count = 0;
+		for (auto& slot : m_slots)
+			count += slot.readers[buffer].load();
+		return count;
+	}
+
+	void sync_back()
+	{
+		const table_type& src = m_front.load(std::memory_order_relaxed)->table;
+		table_type& dst = m_back->table;
+		if (src.getWidth() != dst.getWidth() || src.getHeight() != dst.getHeight() ||
+		    src.getRowWords() != dst.getRowWords()) {
+			dst = src;
+			return;
+		}
+		const size_t row_words = src.getRowWords();
+		for (size_t i = 0; i < m_stale.size(); ++i) {
+			for (uint64 w = m_stale[i]; w != 0; w &= w - 1) {
+				size_t r = (i << 6) + util::ctz(w);
+				if (r >= src.getPadHeight())
+					break;
+				int32 y = static_cast<int32>(r) - static_cast<int32>(buffer_size);
+				std::memcpy(dst.row_data(y), src.row_data(y), row_words * sizeof(PackType));
+			}
+		}
+	}
+
+	std::atomic<Buffer*> m_front;
+	mutable ReaderSlot m_slots[reader_slots];
+	Buffer m_buffers[2];
+	Buffer* m_back;
+	bool m_synced;               ///< back table has had stale rows copied
+	std::vector<uint64> m_dirty; ///< rows changed in the back table since last publish
+	std::vector<uint64> m_stale; ///< rows the back table is missing from the front table
+};
+
+} // namespace inx::data
+
+#endif // INXLIB_DATA_VERSIONED_BIT_TABLE_HPP
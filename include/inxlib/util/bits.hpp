@@ -614,6 +614,67 @@ struct bit_nshift_mask_c : std::integral_constant<decltype(Value), bit_nshift_ma
 template <size_t From, size_t To, size_t Count, auto Value>
 inline constexpr decltype(Value) bit_nshift_mask_v = bit_nshift_mask_c<From, To, Count, Value>::value;
 
+///
+/// bit_stride_mask: mask selecting blocks of Group bits repeated every Group*Stride bits
+///   Stride: spacing between spread bits
+///   Group: block size
+///
+template <typename Type, size_t Stride>
+constexpr Type
+bit_stride_mask(size_t Group) noexcept
+{
+	static_assert(std::is_integral_v<Type> && std::is_unsigned_v<Type>, "Type must be unsigned integral");
+	Type ans = 0;
+	for (size_t i = 0; i < sizeof(Type) * byte_size; i += Group * Stride)
+		ans |= make_mask<Type>(Group, i);
+	return ans;
+}
+
+///
+/// bit_spread: spreads the low bits of Value so bit i moves to bit i*Stride,
+/// a portable pdep with a strided mask
+///   Stride: power of 2 spacing
+///   Value: only the lowest (bits/Stride) bits are used
+///
+template <size_t Stride, typename Type>
+constexpr Type
+bit_spread(Type Value) noexcept
+{
+	static_assert(std::is_integral_v<Type> && std::is_unsigned_v<Type>, "Type must be unsigned integral");
+	static_assert(std::has_single_bit(Stride) && Stride < sizeof(Type) * byte_size, "Stride must be power of 2");
+	constexpr size_t count = sizeof(Type) * byte_size / Stride;
+	if constexpr (Stride == 1) {
+		return Value;
+	} else {
+		Value &= make_mask<Type>(count);
+		for (size_t g = count >> 1; g > 0; g >>= 1)
+			Value = static_cast<Type>((Value | (Value << (g * (Stride - 1)))) & bit_stride_mask<Type, Stride>(g));
+		return Value;
+	}
+}
+
+///
+/// bit_compact: inverse of bit_spread, gathers every Stride bit into the low bits,
+/// a portable pext with a strided mask
+///   Stride: power of 2 spacing
+///
+template <size_t Stride, typename Type>
+constexpr Type
+bit_compact(Type Value) noexcept
+{
+	static_assert(std::is_integral_v<Type> && std::is_unsigned_v<Type>, "Type must be unsigned integral");
+	static_assert(std::has_single_bit(Stride) && Stride < sizeof(Type) * byte_size, "Stride must be power of 2");
+	constexpr size_t count = sizeof(Type) * byte_size / Stride;
+	if constexpr (Stride == 1) {
+		return Value;
+	} else {
+		Value &= bit_stride_mask<Type, Stride>(1);
+		for (size_t g = 1; g < count; g <<= 1)
+			Value = static_cast<Type>((Value | (Value >> (g * (Stride - 1)))) & bit_stride_mask<Type, Stride>(g << 1));
+		return Value;
+	}
+}
+
 #if defined(__GNUC__) || defined(__clang__)
 
 template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
@@ -651,6 +712,29 @@ popcount(T val) noexcept
 	}
 }
 
+///
+/// bit_select: index of the k-th (from 0) set bit of val, a broadword binary search
+/// on popcounts of halves
+///
+template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+constexpr int
+bit_select(T val, uint32 k) noexcept
+{
+	using U = std::make_unsigned_t<T>;
+	U v = static_cast<U>(val);
+	assert(static_cast<uint32>(popcount(v)) > k);
+	int pos = 0;
+	for (int s = sizeof(U) * byte_size / 2; s > 0; s >>= 1) {
+		const uint32 c = static_cast<uint32>(popcount(static_cast<U>(v & make_mask<U>(s))));
+		if (k >= c) {
+			k -= c;
+			v = static_cast<U>(v >> s);
+			pos += s;
+		}
+	}
+	return pos;
+}
+
 template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
 constexpr int
 clz_index(T val) noexcept
@@ -0,0 +1,74 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXLIB_UTIL_PARALLEL_HPP
+#define INXLIB_UTIL_PARALLEL_HPP
+
+#include <algorithm>
+#include <inxlib/inx.hpp>
+#include <thread>
+#include <vector>
+
+namespace inx::util {
+
+/// @brief Run fn(begin, end) over [begin, end) split into contiguous ranges across threads.
+template <typename Fn>
+void
+parallel_ranges(int64 begin, int64 end, uint32 threads, int64 align, Fn&& fn)
+{
+	const int64 count = end - begin;
+	if (threads <= 1 || count <= align) {
+		if (count > 0)
+			fn(begin, end);
+		return;
+	}
+	int64 chunk = (count + threads - 1) / threads;
+	chunk = (chunk + align - 1) / align * align;
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for (int64 i = begin + chunk; i < end; i += chunk)
+		workers.emplace_back([&fn, i, e = std::min(i + chunk, end)]() { fn(i, e); });
+	fn(begin, std::min(begin + chunk, end));
+	for (auto& w : workers)
+		w.join();
+}
+
+/// @brief Run fa and fb, fa on a new thread if fork is true.
+template <typename FnA, typename FnB>
+void
+parallel_invoke(bool fork, FnA&& fa, FnB&& fb)
+{
+	if (!fork) {
+		fa();
+		fb();
+		return;
+	}
+	std::thread worker([&fa]() { fa(); });
+	fb();
+	worker.join();
+}
+
+} // namespace inx::util
+
+#endif // INXLIB_UTIL_PARALLEL_HPP
@@ -0,0 +1,253 @@
+/*
+MIT License
+
+Copyright (c) 2024 Ryan Hechenberger
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef INXFLOW_DATA_GRID_SERIALIZE_HPP
+#define INXFLOW_DATA_GRID_SERIALIZE_HPP
+
+#include "serialize.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <inxlib/data/bit_table.hpp>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace inx::flow::data {
+
+enum class GridFormat : uint8
+{
+	Native, // header then the raw bit_table word buffer
+	Pbm     // raw-binary portable bitmap (P4), BitCount 1 only
+};
+
+/**
+ * Serializes a bit_table, loaded once and shared by commands through the grid group.
+ *
+ * Loading detects the format from the stream, PBM P4 or the native format.
+ * The native format is an inx::data::bit_table_header followed by the table word buffer as stored
+ * in memory, the same as inx::data::write_snapshot, and only loads on a matching layout and endianness.
+ * Saving uses the format last loaded, or PBM if the path ends in .pbm.
+ */
+template <size_t BitCount = 1, size_t BufferSize = 0, std::unsigned_integral PackType = size_t>
+class GridSerialize
+{
+public:
+	using table_type = inx::data::bit_table<BitCount, BufferSize, PackType>;
+	using pack_type = PackType;
+	using native_header = inx::data::bit_table_header;
+	static constexpr std::array<char, 4> native_magic = native_header::snapshot_magic;
+	static constexpr uint8 native_version = native_header::current_version;
+
+	GridSerialize() = default;
+	GridSerialize(uint32 width, uint32 height)
+	  : m_table(width, height)
+	{
+	}
+
+	static consteval bool ser_binary() noexcept { return true; }
+
+	void load(const std::filesystem::path&, std::istream& in) { load(in); }
+	void load(std::istream& in)
+	{
+		char magic[2];
+		if (!in.read(magic, 2))
+			throw std::runtime_error("grid: empty stream");
+		if (magic[0] == 'P' && magic[1] == '4') {
+			load_pbm(in);
+			m_format = GridFormat::Pbm;
+		} else if (magic[0] == native_magic[0] && magic[1] == native_magic[1]) {
+			load_native(in);
+			m_format = GridFormat::Native;
+		} else {
+			throw std::runtime_error("grid: unknown format");
+		}
+	}
+	void save(const std::filesystem::path& path, std::ostream& out)
+	{
+		if (path.extension() == ".pbm")
+			m_format = GridFormat::Pbm;
+		save(out);
+	}
+	void save(std::ostream& out)
+	{
+		if (m_format == GridFormat::Pbm)
+			save_pbm(out);
+		else
+			save_native(out);
+		if (!out)
+			throw std::runtime_error("grid: write failed");
+	}
+
+	GridFormat format() const noexcept { return m_format; }
+	void format(GridFormat f) noexcept { m_format = f; }
+
+	table_type& table() noexcept { return m_table; }
+	const table_type& table() const noexcept { return m_table; }
+
+protected:
+	static constexpr std::array<uint8, 256> make_reverse() noexcept
+	{
+		std::array<uint8, 256> rev{};
+		for (uint32 i = 0; i < 256; ++i) {
+			uint32 r = 0;
+			for (uint32 b = 0; b < 8; ++b)
+				r |= ((i >> b) & 1) << (7 - b);
+			rev[i] = static_cast<uint8>(r);
+		}
+		return rev;
+	}
+	/// PBM packs the first cell in the msb of a byte, cells are lsb first
+	static constexpr std::array<uint8, 256> reverse_byte = make_reverse();
+
+	static uint32 read_pbm_number(std::istream& in)
+	{
+		int c = in.get();
+		while (c != std::char_traits<char>::eof() && (std::isspace(c) || c == '#')) {
+			if (c == '#') {
+				while (c != std::char_traits<char>::eof() && c != '\n' && c != '\r')
+					c = in.get();
+			}
+			c = in.get();
+		}
+		if (c == std::char_traits<char>::eof() || !std::isdigit(c))
+			throw std::runtime_error("grid: invalid pbm header");
+		uint64 value = 0;
+		while (c != std::char_traits<char>::eof() && std::isdigit(c)) {
+			value = value * 10 + static_cast<uint64>(c - '0');
+			if (value > std::numeric_limits<int32>::max())
+				throw std::runtime_error("grid: pbm dimension too large");
+			c = in.get();
+		}
+		// a single whitespace separates the header from the raster
+		if (c == std::char_traits<char>::eof() || !std::isspace(c))
+			throw std::runtime_error("grid: invalid pbm header");
+		return static_cast<uint32>(value);
+	}
+
+	void load_pbm(std::istream& in)
+	{
+		if constexpr (BitCount != 1) {
+			throw std::runtime_error("grid: pbm requires a 1 bit table");
+		} else {
+			const uint32 width = read_pbm_number(in);
+			const uint32 height = read_pbm_number(in);
+			if (width == 0 || height == 0)
+				throw std::runtime_error("grid: empty pbm");
+			const size_t row_bytes = (width + 7) / 8;
+			std::vector<char> bytes(row_bytes);
+			table_type table(width, height, m_table.get_resource());
+			for (uint32 y = 0; y < height; ++y) {
+				if (!in.read(bytes.data(), static_cast<std::streamsize>(row_bytes)))
+					throw std::runtime_error("grid: truncated pbm");
+				pack_type* row = table.row_data(static_cast<int32>(y));
+				for (size_t i = 0; i < row_bytes; i += sizeof(pack_type)) {
+					const size_t n = std::min(sizeof(pack_type), row_bytes - i);
+					pack_type w = 0;
+					for (size_t k = 0; k < n; ++k)
+						w |= static_cast<pack_type>(reverse_byte[static_cast<uint8>(bytes[i + k])]) << (8 * k);
+					const size_t cells = std::min<size_t>(table_type::pack_bits, width - i * 8);
+					inx::data::details::bit_row_write<pack_type>(
+					  row, static_cast<int64>(BufferSize + i * 8), w, inx::util::make_mask<pack_type>(cells));
+				}
+			}
+			m_table = std::move(table);
+		}
+	}
+	void save_pbm(std::ostream& out) const
+	{
+		if constexpr (BitCount != 1) {
+			throw std::runtime_error("grid: pbm requires a 1 bit table");
+		} else {
+			const uint32 width = m_table.getWidth(), height = m_table.getHeight();
+			out << "P4\n" << width << ' ' << height << '\n';
+			const size_t row_bytes = (width + 7) / 8;
+			std::vector<char> bytes(row_bytes);
+			for (uint32 y = 0; y < height; ++y) {
+				const pack_type* row = m_table.row_data(static_cast<int32>(y));
+				const int64 limit = static_cast<int64>(BufferSize + width);
+				for (size_t i = 0; i < row_bytes; i += sizeof(pack_type)) {
+					pack_type w = inx::data::details::bit_row_read(row, static_cast<int64>(BufferSize + i * 8), limit);
+					const size_t n = std::min(sizeof(pack_type), row_bytes - i);
+					for (size_t k = 0; k < n; ++k)
+						bytes[i + k] = static_cast<char>(reverse_byte[static_cast<uint8>(w >> (8 * k))]);
+				}
+				out.write(bytes.data(), static_cast<std::streamsize>(row_bytes));
+			}
+		}
+	}
+
+	void load_native(std::istream& in)
+	{
+		native_header head;
+		std::memcpy(head.magic.data(), native_magic.data(), 2);
+		if (!in.read(reinterpret_cast<char*>(&head) + 2, sizeof(native_header) - 2))
+			throw std::runtime_error("grid: truncated header");
+		if (head.magic != native_magic || head.version != native_version)
+			throw std::runtime_error("grid: invalid header");
+		if (!head.same_layout<BitCount, BufferSize, PackType>())
+			throw std::runtime_error("grid: layout mismatch");
+		if (head.width == 0 || head.height == 0)
+			throw std::runtime_error("grid: empty grid");
+		table_type table(head.width, head.height, m_table.get_resource());
+		// rows may be stored with a different alignment
+		const size_t rows = table.getPadHeight();
+		const size_t stored = head.row_words, words = table.getRowWords();
+		if (stored < (static_cast<size_t>(table.getPadWidth() + table_type::item_count - 1) >> table_type::pack_size))
+			throw std::runtime_error("grid: invalid row words");
+		if (stored == words) {
+			if (!in.read(reinterpret_cast<char*>(table.data()),
+			             static_cast<std::streamsize>(rows * words * sizeof(pack_type))))
+				throw std::runtime_error("grid: truncated data");
+		} else {
+			std::vector<pack_type> row(stored);
+			for (size_t i = 0; i < rows; ++i) {
+				if (!in.read(reinterpret_cast<char*>(row.data()),
+				             static_cast<std::streamsize>(stored * sizeof(pack_type))))
+					throw std::runtime_error("grid: truncated data");
+				std::copy_n(row.data(), std::min(stored, words), table.data() + i * words);
+			}
+		}
+		m_table = std::move(table);
+	}
+	void save_native(std::ostream& out) const
+	{
+		const auto head = native_header::make(native_magic, m_table);
+		out.write(reinterpret_cast<const char*>(&head), sizeof(native_header));
+		if (m_table.data() != nullptr)
+			out.write(reinterpret_cast<const char*>(m_table.data()),
+			          static_cast<std::streamsize>(m_table.calc_cells_words() * sizeof(pack_type)));
+	}
+
+	table_type m_table;
+	GridFormat m_format = GridFormat::Native;
+};
+
+} // namespace inx::flow::data
+
+#endif // INXFLOW_DATA_GRID_SERIALIZE_HPP
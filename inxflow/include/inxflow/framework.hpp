@@ -26,6 +26,7 @@ SOFTWARE.
 #define INXFLOW_FRAMEWORK_HPP
 
 #include "cmd/command.hpp"
+#include "data/grid_serialize.hpp"
 #include "data/group_template.hpp"
 #include "data/string_serialize.hpp"
 #include "types.hpp"
@@ -59,6 +60,7 @@ struct CommandReg
 
 using var_string = data::StringSerialize;
 using var_file = data::StringSerialize;
+using var_grid = data::GridSerialize<>;
 
 enum VarGet
 {
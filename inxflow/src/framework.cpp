@@ -428,6 +428,9 @@ framework_default(Framework& fw)
 	var_sig = fw.emplace_signature<data::SerializeWrap<var_file>>("file"sv).first;
 	assert(var_sig != nullptr);
 	fw.emplace_scope("file"sv, signature(*var_sig));
+	var_sig = fw.emplace_signature<data::SerializeWrap<var_grid>>("grid"sv).first;
+	assert(var_sig != nullptr);
+	fw.emplace_scope("grid"sv, signature(*var_sig));
 
 	{
 		auto var_cmd = fw.emplace_command("inxflow:serialize"sv).first;
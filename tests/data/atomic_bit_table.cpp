@@ -0,0 +1,128 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <inxlib/data/atomic_bit_table.hpp>
+#include <memory_resource>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace inx;
+using namespace inx::data;
+
+template <size_t BitCount, size_t BufferSize>
+bool
+same_cells(const bit_table<BitCount, BufferSize>& a, const atomic_bit_table<BitCount, BufferSize>& b)
+{
+	const int32 buffer = static_cast<int32>(BufferSize);
+	for (int32 y = -buffer; y < static_cast<int32>(a.getHeight()) + buffer; ++y)
+		for (int32 x = -buffer; x < static_cast<int32>(a.getWidth()) + buffer; ++x)
+			if (a.bit_get(x, y) != b.bit_get(x, y))
+				return false;
+	return true;
+}
+
+/// region ops on the atomic table give the same cells as the plain bit_table ops
+template <size_t BitCount, size_t BufferSize, size_t SrcBufferSize>
+void
+check_region_ops(uint64 seed)
+{
+	using table = bit_table<BitCount, BufferSize>;
+	using cell = bit_cell<BitCount, size_t>;
+	using op = typename table::op;
+	constexpr uint32 values = 1u << BitCount;
+	const int32 buffer = static_cast<int32>(BufferSize);
+	std::mt19937_64 rng(seed);
+	std::pmr::monotonic_buffer_resource res;
+	for (int round = 0; round < 100; ++round) {
+		const uint32 width = static_cast<uint32>(rng() % 300 + 1), height = static_cast<uint32>(rng() % 8 + 1);
+		table ref(width, height);
+		for (int i = 0; i < 300; ++i)
+			ref.bit_set(static_cast<int32>(rng() % width), static_cast<int32>(rng() % height), rng() % values);
+		atomic_bit_table<BitCount, BufferSize> at(ref);
+		const int32 x = static_cast<int32>(rng() % (width + BufferSize)) - buffer;
+		const int32 y = static_cast<int32>(rng() % (height + BufferSize)) - buffer;
+		const uint32 w = static_cast<uint32>(rng() % (static_cast<int32>(width) + buffer - x) + 1);
+		const uint32 h = static_cast<uint32>(rng() % (static_cast<int32>(height) + buffer - y) + 1);
+		const op OP = static_cast<op>(rng() % 4);
+		switch (rng() % 3) {
+		case 0: { // constant fill, bit_table only fills inside the table
+			const auto value = rng() % values;
+			const int32 fx = static_cast<int32>(rng() % width), fy = static_cast<int32>(rng() % height);
+			const int32 fw = static_cast<int32>(rng() % (width - fx) + 1);
+			const int32 fh = static_cast<int32>(rng() % (height - fy) + 1);
+			ref.region_op_fill(OP, value, fx, fy, fw, fh);
+			at.region_op_fill(OP, value, fx, fy, fw, fh);
+			break;
+		}
+		case 1: { // bit_table source, combined or copied
+			bit_table<BitCount, SrcBufferSize> src(w, h);
+			for (uint32 i = 0; i < w * h; ++i)
+				src.bit_set(static_cast<int32>(rng() % w), static_cast<int32>(rng() % h), rng() % values);
+			if (rng() % 5 == 0) {
+				for (uint32 j = 0; j < h; ++j)
+					for (uint32 i = 0; i < w; ++i)
+						ref.bit_set(x + static_cast<int32>(i), y + static_cast<int32>(j), src.bit_get(i, j));
+				at.region_copy(src, x, y);
+			} else {
+				src.region_op(OP, ref, x, y);
+				at.region_op(OP, src, x, y);
+			}
+			break;
+		}
+		default: { // bit_cell source
+			const auto cw = static_cast<typename cell::length_type>(std::min<uint32>(w, 255));
+			const auto ch = static_cast<typename cell::length_type>(std::min<uint32>(h, 255));
+			cell* src = cell::construct(res, cw, ch);
+			for (uint32 i = 0; i < static_cast<uint32>(cw) * ch; ++i)
+				src->bit_set(static_cast<int32>(rng() % cw), static_cast<int32>(rng() % ch), rng() % values);
+			src->region_op(OP, ref, x, y);
+			at.region_op(OP, *src, x, y);
+			break;
+		}
+		}
+		REQUIRE(same_cells(ref, at));
+	}
+}
+
+} // namespace
+
+TEST_CASE("atomic_bit_table region ops match bit_table", "[atomic_bit_table]")
+{
+	check_region_ops<1, 0, 0>(1);
+	check_region_ops<1, 3, 70>(2);
+	check_region_ops<2, 2, 0>(3);
+	check_region_ops<3, 1, 2>(4);
+	check_region_ops<4, 0, 5>(5);
+}
+
+TEST_CASE("atomic_bit_table concurrent writers to shared words keep every update", "[atomic_bit_table]")
+{
+	constexpr int32 width = 257, height = 16, threads = 4;
+	atomic_bit_table<2> table(width, height);
+	bit_table<2> stamp(1, height);
+	for (int32 y = 0; y < height; ++y)
+		stamp.bit_set(0, y, 2);
+	std::vector<std::thread> workers;
+	for (int32 t = 0; t < threads; ++t) {
+		workers.emplace_back([&table, &stamp, t] {
+			for (int32 x = t; x < width; x += threads) {
+				// interleaved columns share every word with the other threads
+				if (x % 2 == 0) {
+					table.region_op(bit_table<2>::op::OR, stamp, x, 0);
+				} else {
+					for (int32 y = 0; y < height; ++y)
+						table.bit_set(x, y, 2);
+				}
+				for (int32 y = 0; y < height; ++y)
+					table.bit_or(x, y, 1);
+			}
+		});
+	}
+	for (auto& w : workers)
+		w.join();
+	for (int32 y = 0; y < height; ++y)
+		for (int32 x = 0; x < width; ++x)
+			REQUIRE(table.bit_get(x, y) == 3);
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <inxlib/data/interval_tree.hpp>
+#include <random>
+#include <vector>
+
+#include "redblack_check.hpp"
+
+namespace {
+
+using namespace inx;
+using namespace inx::data;
+
+struct span_node : interval_tree_tag<int32>
+{};
+using span_tree = interval_tree<span_node>;
+
+} // namespace
+
+TEST_CASE("interval_tree queries match a linear scan", "[interval_tree]")
+{
+	std::mt19937_64 rng(1);
+	for (int round = 0; round < 20; ++round) {
+		std::vector<span_node> nodes(rng() % 400 + 1);
+		span_tree tree;
+		for (auto& node : nodes) {
+			const int32 low = static_cast<int32>(rng() % 1000);
+			node.set_interval(low, low + static_cast<int32>(rng() % 100));
+			tree.insert(node);
+		}
+		// erase a third, checking the max high is kept on removal
+		for (auto& node : nodes)
+			if (rng() % 3 == 0)
+				tree.erase(node);
+		std::vector<const span_node*> in_order;
+		for (auto& n : tree)
+			in_order.push_back(&n);
+		REQUIRE(std::is_sorted(in_order.begin(), in_order.end(), [](const span_node* a, const span_node* b) {
+			return a->interval_low() < b->interval_low();
+		}));
+		REQUIRE(test::redblack_errors(tree, in_order) == 0);
+
+		for (int q = 0; q < 200; ++q) {
+			const int32 lo = static_cast<int32>(rng() % 1100), hi = lo + static_cast<int32>(rng() % 50);
+			std::vector<const span_node*> expect, found;
+			for (auto* n : in_order)
+				if (n->interval_low() < hi && lo < n->interval_high())
+					expect.push_back(n);
+			tree.find_overlapping(lo, hi, [&found](span_node& n) { found.push_back(&n); });
+			REQUIRE(found == expect);
+
+			const span_node* any = tree.any_overlap(lo, hi);
+			if (expect.empty())
+				REQUIRE(any == nullptr);
+			else
+				REQUIRE(std::find(expect.begin(), expect.end(), any) != expect.end());
+
+			expect.clear();
+			found.clear();
+			for (auto* n : in_order)
+				if (n->interval_low() <= lo && lo < n->interval_high())
+					expect.push_back(n);
+			tree.stabbing(lo, [&found](span_node& n) { found.push_back(&n); });
+			REQUIRE(found == expect);
+		}
+	}
+}
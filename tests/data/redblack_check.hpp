@@ -0,0 +1,84 @@
+#ifndef INXLIB_TESTS_DATA_REDBLACK_CHECK_HPP
+#define INXLIB_TESTS_DATA_REDBLACK_CHECK_HPP
+
+#include <inxlib/data/redblack_tree.hpp>
+#include <vector>
+
+namespace inx::test {
+
+/// errors found in a redblack tree: broken links, red-red edges, unequal black heights, stale augments
+template <typename Tree>
+struct redblack_check
+{
+	using node_tag = typename Tree::node_tag;
+	using value_type = typename Tree::value_type;
+
+	size_t errors = 0;
+
+	/// black height of the subtree at node
+	size_t check(const node_tag* node)
+	{
+		if (node == nullptr)
+			return 1;
+		if (node->left() != nullptr && node->left()->parent() != node)
+			++errors;
+		if (node->right() != nullptr && node->right()->parent() != node)
+			++errors;
+		if (node->is_red() && (!node->child_is_black(0) || !node->child_is_black(1)))
+			++errors;
+		const size_t lh = check(node->left()), rh = check(node->right());
+		if (lh != rh)
+			++errors;
+		if constexpr (Tree::order_statistic) {
+			using order_tag = typename Tree::order_tag;
+			const size_t size = 1 + order_tag::subtree_size(node->left()) + order_tag::subtree_size(node->right());
+			if (static_cast<const order_tag&>(*node).subtree_size() != size)
+				++errors;
+		}
+		if constexpr (Tree::augmented) {
+			using augment = typename Tree::augment_type;
+			using aggregate_tag = data::redblack_tree_aggregate_tag<typename augment::value_type, typename Tree::tag>;
+			typename augment::value_type agg = augment::value(static_cast<const value_type&>(*node));
+			if (node->left() != nullptr)
+				agg = augment::combine(aggregate_tag::subtree_aggregate(node->left()), agg);
+			if (node->right() != nullptr)
+				agg = augment::combine(agg, aggregate_tag::subtree_aggregate(node->right()));
+			if (!(agg == static_cast<const aggregate_tag&>(*node).subtree_aggregate()))
+				++errors;
+		}
+		return lh + node->is_black();
+	}
+
+	/// check tree holds exactly nodes, in order
+	size_t operator()(const Tree& tree, const std::vector<const value_type*>& nodes)
+	{
+		if (tree.size() != nodes.size())
+			++errors;
+		if (!tree.empty()) {
+			const node_tag& root = static_cast<const node_tag&>(tree.root());
+			if (!root.is_black() || root.parent() != nullptr)
+				++errors;
+			check(&root);
+		}
+		size_t i = 0;
+		for (const value_type& node : tree) {
+			if (i >= nodes.size() || &node != nodes[i])
+				++errors;
+			++i;
+		}
+		if (i != nodes.size())
+			++errors;
+		return errors;
+	}
+};
+
+template <typename Tree>
+size_t
+redblack_errors(const Tree& tree, const std::vector<const typename Tree::value_type*>& nodes)
+{
+	return redblack_check<Tree>()(tree, nodes);
+}
+
+} // namespace inx::test
+
+#endif // INXLIB_TESTS_DATA_REDBLACK_CHECK_HPP
@@ -0,0 +1,152 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <inxlib/data/redblack_set_ops.hpp>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "redblack_check.hpp"
+
+namespace {
+
+using namespace inx;
+using namespace inx::data;
+
+struct set_node : redblack_tree_order_tag<>
+{
+	int64 key;
+	bool operator<(const set_node& other) const noexcept { return key < other.key; }
+};
+using set_tree = redblack_tree<set_node>;
+
+enum class set_op
+{
+	union_,
+	intersection,
+	difference
+};
+
+/// distinct sorted keys in [0, range)
+std::vector<int64>
+make_keys(std::mt19937_64& rng, size_t n, int64 range)
+{
+	std::vector<int64> keys(n);
+	for (auto& k : keys)
+		k = static_cast<int64>(rng() % static_cast<uint64>(range));
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	return keys;
+}
+
+/// tree of heap allocated nodes, freed by the discard callback or at the end of the test
+set_tree
+make_tree(const std::vector<int64>& keys)
+{
+	std::vector<set_node*> nodes;
+	for (int64 k : keys) {
+		nodes.push_back(new set_node);
+		nodes.back()->key = k;
+	}
+	set_tree tree;
+	tree.assign_sorted(nodes.begin(), nodes.end());
+	return tree;
+}
+
+void
+free_tree(set_tree& tree)
+{
+	std::vector<set_node*> nodes;
+	for (auto& n : tree)
+		nodes.push_back(&n);
+	tree.clear();
+	for (auto* n : nodes)
+		delete n;
+}
+
+void
+run_set_op(set_op op, size_t max_size, uint32 threads, uint64 seed)
+{
+	std::mt19937_64 rng(seed);
+	for (int round = 0; round < 30; ++round) {
+		const int64 range = static_cast<int64>(rng() % (2 * max_size) + 1);
+		const auto ka = make_keys(rng, rng() % max_size, range);
+		const auto kb = make_keys(rng, rng() % max_size, range);
+		set_tree a = make_tree(ka), b = make_tree(kb);
+		std::vector<int64> expect;
+		std::atomic<size_t> discarded{0};
+		auto discard = [&discarded](set_node& n) {
+			discarded.fetch_add(1, std::memory_order_relaxed);
+			delete &n;
+		};
+		switch (op) {
+		case set_op::union_:
+			std::set_union(ka.begin(), ka.end(), kb.begin(), kb.end(), std::back_inserter(expect));
+			tree_union(a, b, std::less<>(), threads, discard);
+			break;
+		case set_op::intersection:
+			std::set_intersection(ka.begin(), ka.end(), kb.begin(), kb.end(), std::back_inserter(expect));
+			tree_intersection(a, b, std::less<>(), threads, discard);
+			break;
+		case set_op::difference:
+			std::set_difference(ka.begin(), ka.end(), kb.begin(), kb.end(), std::back_inserter(expect));
+			tree_difference(a, b, std::less<>(), threads, discard);
+			break;
+		}
+		REQUIRE(b.empty());
+		std::vector<const set_node*> nodes;
+		std::vector<int64> keys;
+		for (auto& n : a) {
+			nodes.push_back(&n);
+			keys.push_back(n.key);
+		}
+		REQUIRE(keys == expect);
+		REQUIRE(test::redblack_errors(a, nodes) == 0);
+		// every node is either kept or discarded exactly once
+		REQUIRE(discarded.load() + a.size() == ka.size() + kb.size());
+		free_tree(a);
+	}
+}
+
+} // namespace
+
+TEST_CASE("tree_union matches std::set_union", "[redblack_set_ops]")
+{
+	run_set_op(set_op::union_, 300, 1, 1);
+	run_set_op(set_op::union_, 20000, 4, 2);
+}
+
+TEST_CASE("tree_intersection matches std::set_intersection", "[redblack_set_ops]")
+{
+	run_set_op(set_op::intersection, 300, 1, 3);
+	run_set_op(set_op::intersection, 20000, 4, 4);
+}
+
+TEST_CASE("tree_difference matches std::set_difference", "[redblack_set_ops]")
+{
+	run_set_op(set_op::difference, 300, 1, 5);
+	run_set_op(set_op::difference, 20000, 4, 6);
+}
+
+TEST_CASE("set operations with an empty tree discard every dropped node", "[redblack_set_ops]")
+{
+	std::mt19937_64 rng(7);
+	const auto keys = make_keys(rng, 5000, 100000);
+	size_t discarded = 0;
+	auto discard = [&discarded](set_node& n) {
+		++discarded;
+		delete &n;
+	};
+	set_tree a = make_tree(keys), b;
+	tree_intersection(a, b, std::less<>(), 1, discard);
+	REQUIRE(a.empty());
+	REQUIRE(discarded == keys.size());
+
+	discarded = 0;
+	set_tree c, d = make_tree(keys);
+	tree_difference(c, d, std::less<>(), 1, discard);
+	REQUIRE(c.empty());
+	REQUIRE(d.empty());
+	REQUIRE(discarded == keys.size());
+}
@@ -0,0 +1,206 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <inxlib/data/redblack_tree.hpp>
+#include <random>
+#include <vector>
+
+#include "redblack_check.hpp"
+
+namespace {
+
+using namespace inx;
+using namespace inx::data;
+
+struct order_node : redblack_tree_order_tag<>
+{
+	int64 key;
+};
+bool
+operator<(int64 a, const order_node& b) noexcept
+{
+	return a < b.key;
+}
+
+struct hash_node;
+
+/// polynomial hash of the keys in order, a non-commutative monoid
+struct hash_augment
+{
+	using value_type = std::pair<uint64, uint64>; // hash, base^count
+	static value_type identity() noexcept { return {0, 1}; }
+	static value_type value(const hash_node& node) noexcept;
+	static value_type combine(const value_type& a, const value_type& b) noexcept
+	{
+		return {a.first * b.second + b.first, a.second * b.second};
+	}
+};
+struct hash_node : redblack_tree_aggregate_tag<hash_augment::value_type>
+{
+	int64 key;
+};
+hash_augment::value_type
+hash_augment::value(const hash_node& node) noexcept
+{
+	return {static_cast<uint64>(node.key) + 7, 1'000'003};
+}
+bool
+operator<(const hash_node& a, int64 b) noexcept
+{
+	return a.key < b;
+}
+
+using order_tree = redblack_tree<order_node>;
+using hash_tree = redblack_tree<hash_node, void, hash_augment>;
+
+template <typename Tree>
+std::vector<const typename Tree::value_type*>
+in_order(const Tree& tree)
+{
+	std::vector<const typename Tree::value_type*> nodes;
+	for (auto& n : tree)
+		nodes.push_back(&n);
+	return nodes;
+}
+
+template <typename Node>
+std::vector<const Node*>
+sorted_nodes(std::vector<Node>& nodes)
+{
+	std::vector<const Node*> res;
+	for (auto& n : nodes)
+		res.push_back(&n);
+	std::stable_sort(res.begin(), res.end(), [](const Node* a, const Node* b) { return a->key < b->key; });
+	return res;
+}
+
+} // namespace
+
+TEST_CASE("redblack_tree insert and erase keep invariants and order statistics", "[redblack_tree]")
+{
+	std::mt19937_64 rng(1);
+	for (int round = 0; round < 20; ++round) {
+		const size_t n = rng() % 600;
+		std::vector<order_node> nodes(n);
+		order_tree tree;
+		std::vector<const order_node*> expect;
+		for (auto& node : nodes) {
+			node.key = static_cast<int64>(rng() % 200);
+			tree.insert(tree.upper_bound(node.key), node);
+			expect.insert(std::upper_bound(expect.begin(),
+			                               expect.end(),
+			                               node.key,
+			                               [](int64 k, const order_node* x) { return k < x->key; }),
+			              &node);
+		}
+		REQUIRE(test::redblack_errors(tree, expect) == 0);
+		for (size_t k = 0; k < expect.size(); ++k) {
+			REQUIRE(&*tree.select(k) == expect[k]);
+			REQUIRE(tree.rank(*expect[k]) == k);
+		}
+		REQUIRE(tree.select(expect.size()) == tree.end());
+		// erase a random half
+		for (size_t i = 0; i < n / 2; ++i) {
+			const size_t k = rng() % expect.size();
+			tree.erase(const_cast<order_node&>(*expect[k]));
+			expect.erase(expect.begin() + static_cast<ptrdiff_t>(k));
+		}
+		REQUIRE(test::redblack_errors(tree, expect) == 0);
+		if (!expect.empty()) {
+			const size_t a = rng() % expect.size(), b = rng() % expect.size();
+			REQUIRE(tree.distance(tree.select(a), tree.select(b)) ==
+			        static_cast<ptrdiff_t>(b) - static_cast<ptrdiff_t>(a));
+		}
+	}
+}
+
+TEST_CASE("redblack_tree aggregates match a linear fold", "[redblack_tree]")
+{
+	std::mt19937_64 rng(2);
+	std::vector<hash_node> nodes(500);
+	hash_tree tree;
+	for (auto& node : nodes) {
+		node.key = static_cast<int64>(rng() % 1000);
+		tree.insert(tree.lower_bound(node.key), node);
+	}
+	// erase some to exercise removal fixups
+	for (size_t i = 0; i < nodes.size(); i += 3)
+		tree.erase(nodes[i]);
+	const auto expect = in_order(tree);
+	REQUIRE(test::redblack_errors(tree, expect) == 0);
+	auto fold = [&expect](size_t first, size_t last) {
+		auto acc = hash_augment::identity();
+		for (size_t i = first; i < last; ++i)
+			acc = hash_augment::combine(acc, hash_augment::value(*expect[i]));
+		return acc;
+	};
+	REQUIRE(tree.aggregate() == fold(0, expect.size()));
+	for (int i = 0; i < 500; ++i) {
+		size_t a = rng() % (expect.size() + 1), b = rng() % (expect.size() + 1);
+		if (a > b)
+			std::swap(a, b);
+		REQUIRE(tree.aggregate_rank(a, b) == fold(a, b));
+		REQUIRE(tree.aggregate(tree.select(a), tree.select(b)) == fold(a, b));
+	}
+}
+
+TEST_CASE("redblack_tree assign_sorted builds a valid tree", "[redblack_tree]")
+{
+	for (size_t n = 0; n <= 300; ++n) {
+		std::vector<hash_node> nodes(n);
+		for (size_t i = 0; i < n; ++i)
+			nodes[i].key = static_cast<int64>(i / 2);
+		std::vector<hash_node*> ptrs;
+		for (auto& node : nodes)
+			ptrs.push_back(&node);
+		hash_tree tree;
+		tree.assign_sorted(ptrs.begin(), ptrs.end());
+		REQUIRE(test::redblack_errors(tree, sorted_nodes(nodes)) == 0);
+	}
+}
+
+TEST_CASE("redblack_tree join and split keep invariants", "[redblack_tree]")
+{
+	std::mt19937_64 rng(3);
+	for (int round = 0; round < 200; ++round) {
+		const size_t n = rng() % 400;
+		std::vector<hash_node> nodes(n);
+		for (auto& node : nodes)
+			node.key = static_cast<int64>(rng() % 300);
+		auto expect = sorted_nodes(nodes);
+		hash_tree tree;
+		for (auto& node : nodes)
+			tree.insert(tree.lower_bound(node.key + 1), node); // after equal keys, as sorted_nodes
+		REQUIRE(test::redblack_errors(tree, expect) == 0);
+
+		// split at a key
+		const int64 key = static_cast<int64>(rng() % 320);
+		hash_tree right = tree.split(key);
+		auto mid =
+		  std::partition_point(expect.begin(), expect.end(), [key](const hash_node* x) { return x->key < key; });
+		std::vector<const hash_node*> left_nodes(expect.begin(), mid), right_nodes(mid, expect.end());
+		REQUIRE(test::redblack_errors(tree, left_nodes) == 0);
+		REQUIRE(test::redblack_errors(right, right_nodes) == 0);
+
+		// join back through the first node of right as pivot, or join2
+		if (!right.empty() && rng() % 2) {
+			hash_node& pivot = right.erase(right.front());
+			tree.join(pivot, right);
+		} else {
+			tree.join2(right);
+		}
+		REQUIRE(right.empty());
+		REQUIRE(test::redblack_errors(tree, expect) == 0);
+
+		// split at a position of an unbalanced pair of sizes
+		if (!expect.empty()) {
+			const size_t k = rng() % 4 == 0 ? 0 : rng() % expect.size();
+			hash_tree tail = tree.split(tree.select(k));
+			const auto at = expect.begin() + static_cast<ptrdiff_t>(k);
+			REQUIRE(test::redblack_errors(tree, std::vector<const hash_node*>(expect.begin(), at)) == 0);
+			REQUIRE(test::redblack_errors(tail, std::vector<const hash_node*>(at, expect.end())) == 0);
+			tree.join2(tail);
+			REQUIRE(test::redblack_errors(tree, expect) == 0);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <inxlib/data/versioned_bit_table.hpp>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace inx;
+using namespace inx::data;
+
+template <typename Table>
+uint64
+count_set(const Table& table)
+{
+	uint64 count = 0;
+	for (int32 y = 0; y < static_cast<int32>(table.getHeight()); ++y)
+		for (int32 x = 0; x < static_cast<int32>(table.getWidth()); ++x)
+			count += table.bit_get(x, y) != 0;
+	return count;
+}
+
+} // namespace
+
+TEST_CASE("versioned_bit_table readers see whole published versions", "[versioned_bit_table]")
+{
+	constexpr int32 width = 70, height = 5, readers = 3;
+	versioned_bit_table<1, 1> table(width, height);
+	std::atomic<bool> done{false};
+	std::atomic<size_t> errors{0};
+	std::vector<std::thread> workers;
+	for (int32 t = 0; t < readers; ++t) {
+		workers.emplace_back([&table, &done, &errors] {
+			uint64 last = 0;
+			while (!done.load()) {
+				auto snap = table.read();
+				// version v has exactly the first v cells set
+				if (count_set(*snap) != snap.version() || snap.version() < last)
+					errors.fetch_add(1);
+				last = snap.version();
+			}
+		});
+	}
+	// one new cell per version, the back table must catch up on the rows of the previous version
+	for (int32 i = 0; i < width * height; ++i) {
+		table.edit().bit_set(i % width, i / width, 1);
+		table.mark_dirty(i / width);
+		table.publish();
+	}
+	done.store(true);
+	for (auto& w : workers)
+		w.join();
+	REQUIRE(errors.load() == 0);
+	REQUIRE(table.version() == static_cast<uint64>(width * height));
+	REQUIRE(count_set(*table.read()) == static_cast<uint64>(width * height));
+	REQUIRE(count_set(table.edit()) == static_cast<uint64>(width * height));
+}
+
+TEST_CASE("versioned_bit_table try_edit refuses a back table still read", "[versioned_bit_table]")
+{
+	versioned_bit_table<2> table(10, 3);
+	auto first = table.read();
+	table.edit().bit_set(1, 1, 3);
+	table.mark_dirty(1);
+	table.publish();
+	REQUIRE(table.try_edit() == nullptr);
+	REQUIRE(first.version() == 0);
+	REQUIRE(first->bit_get(1, 1) == 0);
+	first.release();
+	REQUIRE(table.try_edit() != nullptr);
+	REQUIRE(table.edit().bit_get(1, 1) == 3);
+}
+
+TEST_CASE("versioned_bit_table allocates both tables from the given resource", "[versioned_bit_table]")
+{
+	std::pmr::monotonic_buffer_resource res;
+	versioned_bit_table<1> table(100, 10, &res);
+	REQUIRE(table.read()->get_resource() == &res);
+	REQUIRE(table.edit().get_resource() == &res);
+	table.publish();
+	REQUIRE(table.read()->get_resource() == &res);
+	REQUIRE(table.edit().get_resource() == &res);
+}